@@ -5,6 +5,8 @@
 
 #include "VoxelGridBaker.h"
 #include "VoxelHeightCache.h"
+#include "VoxelDistanceField.h"
+#include "VoxelHorizonMap.h"
 #include "DrawDebugHelpers.h"
 
 // Sets default values
@@ -22,26 +24,8 @@ bool AHeightQueryProbeActor::WorldXYToCell(const FVector& WorldPos, int32& OutX,
 	if (!GridBaker || !HeightCache || !HeightCache->IsValid())
 		return false;
 
-	const FVector Min = GridBaker->GridMinWorld;
-	const float CellSizeCm = GridBaker->CellSizeCm;
-
-	// Guard: valid grid cell size
-	if (CellSizeCm <= 0.0f)
-		return false;
-
-	// Transform world XY into grid-local space
-	const float LocalX = WorldPos.X - Min.X;
-	const float LocalY = WorldPos.Y - Min.Y;
-
-	// Convert local position into integer cell indices
-	OutX = FMath::FloorToInt(LocalX / CellSizeCm);
-	OutY = FMath::FloorToInt(LocalY / CellSizeCm);
-
-	// Bounds check against baked grid size
-	if (OutX < 0 || OutY < 0 || OutX >= HeightCache->GridSize.X || OutY >= HeightCache->GridSize.Y)
-		return false;
-
-	return true;
+	// Use cache grid metadata (cache may be derived at a coarser cell size); bounds-checked against current snapshot
+	return HeightCache->WorldToCell(WorldPos, OutX, OutY);
 }
 
 // Query maximum terrain height at current actor location
@@ -71,9 +55,8 @@ void AHeightQueryProbeActor::QueryHeightAtMyLocation()
 		return;
 	}
 
-	// Resolve cell index and read cached max height (cm)
-	const int32 Idx = HeightCache->ToIndex(X, Y);
-	const float MaxZcm = HeightCache->MaxHeightCm[Idx];
+	// Read cached max height (cm) from current snapshot
+	const float MaxZcm = HeightCache->GetMaxHeightCm(X, Y);
 
 	// Convert to ASL using calibrated sea level (cm -> m)
 	const float SeaLevelCm = HeightCache->SeaLevelWorldZCm;
@@ -84,6 +67,20 @@ void AHeightQueryProbeActor::QueryHeightAtMyLocation()
 		P.X, P.Y, X, Y, MaxZcm, MaxZcm / 100.0f, SeaLevelCm, HeightASLm
 	);
 
+	// Distance field channel (if baked): single lookup
+	if (HeightCache->FindChannel(FVoxelDistanceField::DistanceChannel))
+	{
+		const float DistCm = HeightCache->GetChannelValue(FVoxelDistanceField::DistanceChannel, X, Y, 0, FLT_MAX);
+		UE_LOG(LogTemp, Display, TEXT("Query: nearest feature %s"),
+			DistCm < FLT_MAX ? *FString::Printf(TEXT("%.1f m"), DistCm / 100.0f) : TEXT("none"));
+	}
+
+	// Horizon map (if baked): sky visibility lookup
+	if (HeightCache->FindChannel(FVoxelHorizonMap::HorizonChannel))
+	{
+		UE_LOG(LogTemp, Display, TEXT("Query: sky visibility %.2f"), HeightCache->GetSkyVisibility(P));
+	}
+
 	// Optional debug visualization at queried height
 	if (bDrawMarker && GetWorld())
 	{
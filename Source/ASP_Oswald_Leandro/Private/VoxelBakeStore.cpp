@@ -0,0 +1,190 @@
+// Local derived-data store for baked voxel height results
+// Computes content hashes for bakes and saves/loads results keyed by hash
+
+#include "VoxelBakeStore.h"
+
+#include "VoxelGridConfig.h"
+#include "VoxelHeightCache.h"
+#include "LandscapeProxy.h"
+#include "Hash/xxhash.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_EDITOR
+#include "LandscapeInfo.h"
+#include "LandscapeEdit.h"
+#endif
+
+namespace VoxelBakeStore
+{
+	// File header identifying stored bake results
+	static constexpr uint32 FileMagic = 0x56484331; // 'VHC1'
+
+	// Bump when bake logic or file layout changes (invalidates old entries)
+	static constexpr int32 FormatVersion = 1;
+
+	// Landscape rows read per step while hashing height data
+	static constexpr int32 HashBandRows = 256;
+}
+
+// Compute content hash over everything that influences the bake result
+FString FVoxelBakeStore::ComputeBakeHash(
+	const ALandscapeProxy* Landscape,
+	const UVoxelGridConfig* Config,
+	const FVector& GridMinWorld,
+	const FIntPoint& GridSize,
+	float CellSizeCm)
+{
+	FXxHash64Builder Builder;
+
+	// Hash plain value bytes
+	auto HashValue = [&Builder](const auto& Value)
+	{
+		Builder.Update(&Value, sizeof(Value));
+	};
+
+	HashValue(VoxelBakeStore::FormatVersion);
+
+	// Grid layout
+	HashValue(GridMinWorld.X);
+	HashValue(GridMinWorld.Y);
+	HashValue(GridSize.X);
+	HashValue(GridSize.Y);
+	HashValue(CellSizeCm);
+
+	// Config parameters affecting sampling and tracing
+	if (Config)
+	{
+		HashValue(Config->CellSizeMeters);
+		HashValue(Config->PaddingMeters);
+		HashValue(Config->SamplesPerAxis);
+		HashValue(Config->TraceStartAboveMeters);
+		HashValue(Config->TraceEndBelowMeters);
+		const uint8 Channel = Config->TraceChannel.GetValue();
+		HashValue(Channel);
+		HashValue(Config->bAdaptiveSampling);
+		if (Config->bAdaptiveSampling)
+		{
+			HashValue(Config->AdaptiveToleranceMeters);
+			HashValue(Config->AdaptiveMaxDepth);
+		}
+	}
+
+	if (Landscape)
+	{
+		// Landscape placement (trace start/end depend on actor Z)
+		const FTransform T = Landscape->GetActorTransform();
+		const FVector Loc = T.GetLocation();
+		const FVector Scale = T.GetScale3D();
+		const FQuat Rot = T.GetRotation();
+		HashValue(Loc.X); HashValue(Loc.Y); HashValue(Loc.Z);
+		HashValue(Scale.X); HashValue(Scale.Y); HashValue(Scale.Z);
+		HashValue(Rot.X); HashValue(Rot.Y); HashValue(Rot.Z); HashValue(Rot.W);
+
+#if WITH_EDITOR
+		// Landscape height data, read in row bands to limit memory
+		ULandscapeInfo* Info = Landscape->GetLandscapeInfo();
+		int32 MinX, MinY, MaxX, MaxY;
+		if (!Info || !Info->GetLandscapeExtent(MinX, MinY, MaxX, MaxY))
+			return FString();
+
+		FLandscapeEditDataInterface EditData(Info);
+		const int32 Width = MaxX - MinX + 1;
+
+		HashValue(MinX); HashValue(MinY); HashValue(MaxX); HashValue(MaxY);
+
+		TArray<uint16> Band;
+		for (int32 Y0 = MinY; Y0 <= MaxY; Y0 += VoxelBakeStore::HashBandRows)
+		{
+			const int32 Y1 = FMath::Min(Y0 + VoxelBakeStore::HashBandRows - 1, MaxY);
+			Band.SetNumZeroed(Width * (Y1 - Y0 + 1));
+			EditData.GetHeightDataFast(MinX, Y0, MaxX, Y1, Band.GetData(), 0);
+			Builder.Update(Band.GetData(), Band.Num() * sizeof(uint16));
+		}
+#else
+		// No height data access outside editor: terrain content unknown, store disabled
+		return FString();
+#endif
+	}
+
+	return FString::Printf(TEXT("%016llx"), Builder.Finalize().Hash);
+}
+
+// Directory for stored bake results
+FString FVoxelBakeStore::GetStoreDir()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("VoxelBakeCache"));
+}
+
+// File path for a stored bake result
+FString FVoxelBakeStore::GetEntryPath(const FString& BakeHash)
+{
+	return FPaths::Combine(GetStoreDir(), BakeHash + TEXT(".vhc"));
+}
+
+// Load stored bake result into cache
+bool FVoxelBakeStore::Load(const FString& BakeHash, UVoxelHeightCache* Cache)
+{
+	// Guard: valid target + hash
+	if (!Cache || BakeHash.IsEmpty())
+		return false;
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *GetEntryPath(BakeHash), FILEREAD_Silent))
+		return false;
+
+	FMemoryReader Ar(Bytes);
+
+	// Header check
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Ar << Magic << Version;
+	if (Magic != VoxelBakeStore::FileMagic || Version != VoxelBakeStore::FormatVersion)
+		return false;
+
+	// Read straight into back buffer (published only if entry is complete)
+	FVoxelHeightSnapshot* Back = Cache->BeginWrite();
+	if (!Back)
+		return false;
+
+	Ar << Back->GridMinWorld << Back->GridSize << Back->CellSizeCm << Back->MaxHeightCm;
+
+	// Guard: truncated or inconsistent entry
+	if (Ar.IsError() || !Back->IsValid())
+	{
+		Cache->AbortWrite();
+		return false;
+	}
+
+	Cache->Publish();
+	Cache->BakeHash = BakeHash;
+	return true;
+}
+
+// Save baked cache result under its hash
+bool FVoxelBakeStore::Save(const FString& BakeHash, const UVoxelHeightCache* Cache)
+{
+	// Guard: valid baked cache + hash
+	if (!Cache || !Cache->IsValid() || BakeHash.IsEmpty())
+		return false;
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Ar(Bytes);
+
+	uint32 Magic = VoxelBakeStore::FileMagic;
+	int32 Version = VoxelBakeStore::FormatVersion;
+	Ar << Magic << Version;
+
+	// Write current snapshot (saving archive only reads; no copy of large height data)
+	{
+		FVoxelHeightReadScope Scope(*Cache);
+		FVoxelHeightSnapshot& Snap = const_cast<FVoxelHeightSnapshot&>(Scope.Get());
+		Ar << Snap.GridMinWorld << Snap.GridSize << Snap.CellSizeCm << Snap.MaxHeightCm;
+	}
+
+	IFileManager::Get().MakeDirectory(*GetStoreDir(), true);
+	return FFileHelper::SaveArrayToFile(Bytes, *GetEntryPath(BakeHash));
+}
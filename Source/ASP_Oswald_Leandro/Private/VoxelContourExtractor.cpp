@@ -0,0 +1,367 @@
+// Elevation contour (isoline) extraction from the baked height grid
+// Tile-parallel marching squares, polylines stitched across tiles, dirty tiles re-extracted only
+
+#include "VoxelContourExtractor.h"
+
+#include "VoxelHeightCache.h"
+#include "Async/ParallelFor.h"
+
+namespace VoxelContour
+{
+	// Square corners: v0 (x,y), v1 (x+1,y), v2 (x+1,y+1), v3 (x,y+1)
+	// Square edges:   e0 v0-v1, e1 v1-v2, e2 v3-v2, e3 v0-v3
+	// Edge pairs per case (bit i = corner i above level); saddles 5/10 resolved by center value
+	static const int8 CaseEdges[16][4] = {
+		{ -1, -1, -1, -1 }, {  3,  0, -1, -1 }, {  0,  1, -1, -1 }, {  3,  1, -1, -1 },
+		{  1,  2, -1, -1 }, {  3,  0,  1,  2 }, {  0,  2, -1, -1 }, {  3,  2, -1, -1 },
+		{  2,  3, -1, -1 }, {  0,  2, -1, -1 }, {  0,  1,  2,  3 }, {  1,  2, -1, -1 },
+		{  1,  3, -1, -1 }, {  0,  1, -1, -1 }, {  3,  0, -1, -1 }, { -1, -1, -1, -1 }
+	};
+
+	// Single marching-squares segment (same layout as a fragment for chaining)
+	struct FSegment
+	{
+		int32 Level = 0;
+		int32 StartEdge = INDEX_NONE;
+		int32 EndEdge = INDEX_NONE;
+		bool bClosed = false;
+		TStaticArray<FVector2f, 2> Points;
+	};
+
+	// Fragment in a chain, optionally walked backwards
+	struct FChainLink
+	{
+		int32 Fragment;
+		bool bReversed;
+	};
+
+	static uint64 CrossingKey(int32 Level, int32 Edge)
+	{
+		return ((uint64)(uint32)Level << 32) | (uint64)(uint32)Edge;
+	}
+
+	// Join fragments sharing a crossing (level + lattice edge) into maximal chains
+	// Every crossing is shared by at most two fragments, so chaining is a linear walk
+	template<typename FragmentType, typename EmitFn>
+	static void ChainFragments(const TArray<const FragmentType*>& Fragments, EmitFn&& Emit)
+	{
+		// End codes: fragment * 2 + (0 = start, 1 = end)
+		TMap<uint64, FIntPoint> Ends;
+		Ends.Reserve(Fragments.Num() * 2);
+		for (int32 i = 0; i < Fragments.Num(); ++i)
+		{
+			const FragmentType* F = Fragments[i];
+			if (F->bClosed)
+				continue;
+
+			for (int32 End = 0; End < 2; ++End)
+			{
+				FIntPoint& Slot = Ends.FindOrAdd(CrossingKey(F->Level, End ? F->EndEdge : F->StartEdge), FIntPoint(INDEX_NONE, INDEX_NONE));
+				(Slot.X == INDEX_NONE ? Slot.X : Slot.Y) = i * 2 + End;
+			}
+		}
+
+		// Other end code at the same crossing (INDEX_NONE = open end)
+		auto Partner = [&](int32 Code)
+		{
+			const FragmentType* F = Fragments[Code / 2];
+			const FIntPoint* Slot = Ends.Find(CrossingKey(F->Level, (Code & 1) ? F->EndEdge : F->StartEdge));
+			if (!Slot)
+				return (int32)INDEX_NONE;
+			return Slot->X == Code ? Slot->Y : Slot->X;
+		};
+
+		TBitArray<> Used(false, Fragments.Num());
+		TArray<FChainLink> Forward, Backward, Links;
+
+		for (int32 i = 0; i < Fragments.Num(); ++i)
+		{
+			if (Used[i])
+				continue;
+			Used[i] = true;
+
+			Forward.Reset();
+			Forward.Add({ i, false });
+
+			bool bClosed = Fragments[i]->bClosed;
+			if (!bClosed)
+			{
+				// Walk forward from the end; entering a fragment at its end means walking it reversed
+				for (int32 Exit = i * 2 + 1;;)
+				{
+					const int32 P = Partner(Exit);
+					if (P == INDEX_NONE)
+						break;
+					if (P / 2 == i)
+					{
+						bClosed = true;
+						break;
+					}
+					if (Used[P / 2])
+						break;
+
+					Used[P / 2] = true;
+					Forward.Add({ P / 2, (P & 1) == 1 });
+					Exit = P ^ 1;
+				}
+			}
+
+			// Walk backward from the start (open chains only)
+			Backward.Reset();
+			if (!bClosed)
+			{
+				for (int32 Exit = i * 2;;)
+				{
+					const int32 P = Partner(Exit);
+					if (P == INDEX_NONE || Used[P / 2])
+						break;
+
+					Used[P / 2] = true;
+					Backward.Add({ P / 2, (P & 1) == 0 });
+					Exit = P ^ 1;
+				}
+			}
+
+			Links.Reset();
+			for (int32 b = Backward.Num() - 1; b >= 0; --b)
+			{
+				Links.Add(Backward[b]);
+			}
+			Links.Append(Forward);
+
+			Emit(Links, bClosed);
+		}
+	}
+
+	// Concatenate chain points (shared crossings appear once)
+	template<typename FragmentType>
+	static void AppendChainPoints(const TArray<const FragmentType*>& Fragments, const TArray<FChainLink>& Links, TArray<FVector2f>& OutPoints)
+	{
+		for (int32 n = 0; n < Links.Num(); ++n)
+		{
+			const auto& Points = Fragments[Links[n].Fragment]->Points;
+			const int32 Count = Points.Num();
+			for (int32 j = (n > 0 ? 1 : 0); j < Count; ++j)
+			{
+				OutPoints.Add(Points[Links[n].bReversed ? Count - 1 - j : j]);
+			}
+		}
+	}
+
+	template<typename FragmentType>
+	static int32 ChainStartEdge(const TArray<const FragmentType*>& Fragments, const TArray<FChainLink>& Links)
+	{
+		const FragmentType* F = Fragments[Links[0].Fragment];
+		return Links[0].bReversed ? F->EndEdge : F->StartEdge;
+	}
+
+	template<typename FragmentType>
+	static int32 ChainEndEdge(const TArray<const FragmentType*>& Fragments, const TArray<FChainLink>& Links)
+	{
+		const FragmentType* F = Fragments[Links.Last().Fragment];
+		return Links.Last().bReversed ? F->StartEdge : F->EndEdge;
+	}
+}
+
+// Full extraction: every tile dirty
+void FVoxelContourExtractor::Extract(const FVoxelHeightSnapshot& Snapshot, const FVoxelContourSettings& InSettings, FVoxelContourSet& OutContours)
+{
+	Settings = InSettings;
+	Settings.IntervalCm = FMath::Max(1.0f, Settings.IntervalCm);
+	Settings.TileSize = FMath::Max(8, Settings.TileSize);
+
+	GridSize = Snapshot.GridSize;
+	GridMinWorld = Snapshot.GridMinWorld;
+	CellSizeCm = Snapshot.CellSizeCm;
+
+	// Tiles partition lattice squares (cell centres are the lattice vertices)
+	NumTiles = FIntPoint(
+		FMath::DivideAndRoundUp(FMath::Max(GridSize.X - 1, 0), Settings.TileSize),
+		FMath::DivideAndRoundUp(FMath::Max(GridSize.Y - 1, 0), Settings.TileSize));
+
+	TileFragments.Reset();
+	TileFragments.SetNum(NumTiles.X * NumTiles.Y);
+	DirtyTiles.Init(true, TileFragments.Num());
+
+	ExtractDirtyAndStitch(Snapshot, OutContours);
+}
+
+void FVoxelContourExtractor::MarkDirty(const FIntRect& DirtyCells)
+{
+	if (!IsExtracted())
+		return;
+
+	// A cell is a corner of the squares to its lower/left and upper/right
+	const int32 SquaresX = GridSize.X - 1;
+	const int32 SquaresY = GridSize.Y - 1;
+	const int32 MinX = FMath::Clamp(DirtyCells.Min.X - 1, 0, SquaresX - 1);
+	const int32 MinY = FMath::Clamp(DirtyCells.Min.Y - 1, 0, SquaresY - 1);
+	const int32 MaxX = FMath::Clamp(DirtyCells.Max.X - 1, 0, SquaresX - 1);
+	const int32 MaxY = FMath::Clamp(DirtyCells.Max.Y - 1, 0, SquaresY - 1);
+	if (DirtyCells.Min.X >= DirtyCells.Max.X || DirtyCells.Min.Y >= DirtyCells.Max.Y)
+		return;
+
+	for (int32 TY = MinY / Settings.TileSize; TY <= MaxY / Settings.TileSize; ++TY)
+	{
+		for (int32 TX = MinX / Settings.TileSize; TX <= MaxX / Settings.TileSize; ++TX)
+		{
+			DirtyTiles[TX + TY * NumTiles.X] = true;
+		}
+	}
+}
+
+void FVoxelContourExtractor::Update(const FVoxelHeightSnapshot& Snapshot, FVoxelContourSet& OutContours)
+{
+	// Grid layout changed: full extract with current levels
+	if (!IsExtracted() || Snapshot.GridSize != GridSize || Snapshot.CellSizeCm != CellSizeCm || !Snapshot.GridMinWorld.Equals(GridMinWorld))
+	{
+		const FVoxelContourSettings CurrentSettings = Settings;
+		Extract(Snapshot, CurrentSettings, OutContours);
+		return;
+	}
+
+	ExtractDirtyAndStitch(Snapshot, OutContours);
+}
+
+int32 FVoxelContourExtractor::GetNumDirtyTiles() const
+{
+	return DirtyTiles.CountSetBits();
+}
+
+// Marching squares over the tile's lattice squares, then chain segments inside the tile
+void FVoxelContourExtractor::ExtractTile(const FVoxelHeightSnapshot& Snapshot, int32 Tile, TArray<FFragment>& OutFragments) const
+{
+	OutFragments.Reset();
+
+	const int32 SizeX = GridSize.X;
+	const float* Heights = Snapshot.MaxHeightCm.GetData();
+	const float Base = Settings.BaseLevelCm;
+	const float Interval = Settings.IntervalCm;
+
+	const int32 X0 = (Tile % NumTiles.X) * Settings.TileSize;
+	const int32 Y0 = (Tile / NumTiles.X) * Settings.TileSize;
+	const int32 X1 = FMath::Min(X0 + Settings.TileSize, GridSize.X - 1);
+	const int32 Y1 = FMath::Min(Y0 + Settings.TileSize, GridSize.Y - 1);
+
+	// Crossing on lattice edge, interpolated from the lower vertex index (identical in both adjacent squares)
+	auto EdgePoint = [&](int32 Edge, float Level)
+	{
+		const bool bVertical = (Edge & 1) != 0;
+		const int32 V0 = Edge >> 1;
+		const int32 V1 = bVertical ? V0 + SizeX : V0 + 1;
+		const float T = (Level - Heights[V0]) / (Heights[V1] - Heights[V0]);
+		const float X = (float)(V0 % SizeX) + (bVertical ? 0.0f : T);
+		const float Y = (float)(V0 / SizeX) + (bVertical ? T : 0.0f);
+		return FVector2f(GridMinWorld.X + (X + 0.5f) * CellSizeCm, GridMinWorld.Y + (Y + 0.5f) * CellSizeCm);
+	};
+
+	TArray<VoxelContour::FSegment> Segments;
+
+	for (int32 Y = Y0; Y < Y1; ++Y)
+	{
+		for (int32 X = X0; X < X1; ++X)
+		{
+			const int32 V0 = X + Y * SizeX;
+			const float H[4] = { Heights[V0], Heights[V0 + 1], Heights[V0 + 1 + SizeX], Heights[V0 + SizeX] };
+
+			// Squares touching cells without terrain produce no contours
+			if (H[0] <= -1e20f || H[1] <= -1e20f || H[2] <= -1e20f || H[3] <= -1e20f)
+				continue;
+
+			const float MinH = FMath::Min(FMath::Min(H[0], H[1]), FMath::Min(H[2], H[3]));
+			const float MaxH = FMath::Max(FMath::Max(H[0], H[1]), FMath::Max(H[2], H[3]));
+
+			// Levels with MinH <= L < MaxH cross this square
+			int32 KMin = FMath::CeilToInt((MinH - Base) / Interval);
+			const int32 KMax = FMath::CeilToInt((MaxH - Base) / Interval) - 1;
+			if (!Settings.bIncludeBelowBase)
+			{
+				KMin = FMath::Max(KMin, 0);
+			}
+
+			const int32 Edges[4] = { V0 * 2, (V0 + 1) * 2 + 1, (V0 + SizeX) * 2, V0 * 2 + 1 };
+
+			for (int32 K = KMin; K <= KMax; ++K)
+			{
+				const float Level = Base + (float)K * Interval;
+
+				int32 Case = (H[0] > Level ? 1 : 0) | (H[1] > Level ? 2 : 0) | (H[2] > Level ? 4 : 0) | (H[3] > Level ? 8 : 0);
+				if ((Case == 5 || Case == 10) && (H[0] + H[1] + H[2] + H[3]) * 0.25f > Level)
+				{
+					Case ^= 15;
+				}
+
+				const int8* Pairs = VoxelContour::CaseEdges[Case];
+				for (int32 p = 0; p < 4 && Pairs[p] >= 0; p += 2)
+				{
+					VoxelContour::FSegment& Seg = Segments.AddDefaulted_GetRef();
+					Seg.Level = K;
+					Seg.StartEdge = Edges[Pairs[p]];
+					Seg.EndEdge = Edges[Pairs[p + 1]];
+					Seg.Points[0] = EdgePoint(Seg.StartEdge, Level);
+					Seg.Points[1] = EdgePoint(Seg.EndEdge, Level);
+				}
+			}
+		}
+	}
+
+	// Tile-local chaining: open ends remain only on tile borders, grid borders and terrain holes
+	TArray<const VoxelContour::FSegment*> SegmentPtrs;
+	SegmentPtrs.Reserve(Segments.Num());
+	for (const VoxelContour::FSegment& Seg : Segments)
+	{
+		SegmentPtrs.Add(&Seg);
+	}
+
+	VoxelContour::ChainFragments(SegmentPtrs, [&](const TArray<VoxelContour::FChainLink>& Links, bool bClosed)
+	{
+		FFragment& Fragment = OutFragments.AddDefaulted_GetRef();
+		Fragment.Level = SegmentPtrs[Links[0].Fragment]->Level;
+		Fragment.StartEdge = VoxelContour::ChainStartEdge(SegmentPtrs, Links);
+		Fragment.EndEdge = VoxelContour::ChainEndEdge(SegmentPtrs, Links);
+		Fragment.bClosed = bClosed;
+		Fragment.Points.Reserve(Links.Num() + 1);
+		VoxelContour::AppendChainPoints(SegmentPtrs, Links, Fragment.Points);
+	});
+}
+
+// Re-extract dirty tiles in parallel, then stitch tile fragments into global polylines
+void FVoxelContourExtractor::ExtractDirtyAndStitch(const FVoxelHeightSnapshot& Snapshot, FVoxelContourSet& OutContours)
+{
+	OutContours.Reset();
+
+	// Guard: baked grid matching the extractor layout
+	if (!Snapshot.IsValid() || Snapshot.GridSize != GridSize)
+		return;
+
+	TArray<int32> Dirty;
+	for (TConstSetBitIterator<> It(DirtyTiles); It; ++It)
+	{
+		Dirty.Add(It.GetIndex());
+	}
+
+	ParallelFor(Dirty.Num(), [&](int32 i)
+	{
+		ExtractTile(Snapshot, Dirty[i], TileFragments[Dirty[i]]);
+	});
+
+	DirtyTiles.Init(false, TileFragments.Num());
+
+	// Stitch: only fragment ends are matched, cost is independent of grid size
+	TArray<const FFragment*> All;
+	for (const TArray<FFragment>& Fragments : TileFragments)
+	{
+		for (const FFragment& Fragment : Fragments)
+		{
+			All.Add(&Fragment);
+		}
+	}
+
+	VoxelContour::ChainFragments(All, [&](const TArray<VoxelContour::FChainLink>& Links, bool bClosed)
+	{
+		OutContours.PolylineStarts.Add(OutContours.Points.Num());
+		OutContours.PolylineLevels.Add(Settings.BaseLevelCm + (float)All[Links[0].Fragment]->Level * Settings.IntervalCm);
+		VoxelContour::AppendChainPoints(All, Links, OutContours.Points);
+	});
+	OutContours.PolylineStarts.Add(OutContours.Points.Num());
+}
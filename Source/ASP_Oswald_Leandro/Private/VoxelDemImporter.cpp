@@ -0,0 +1,607 @@
+// Streaming DEM raster importer for voxel height caches
+// Reduces GeoTIFF / 16-bit raw height tiles straight into per-cell max heights (no landscape)
+
+#include "VoxelDemImporter.h"
+
+#include "VoxelGridConfig.h"
+#include "VoxelHeightCache.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+namespace VoxelDem
+{
+	// Supported raster sample formats
+	enum class ESampleFormat : uint8
+	{
+		UInt16,
+		Int16,
+		Float32
+	};
+
+	// Parsed raster layout + georeference (pixel data stays in the mapped file)
+	struct FRaster
+	{
+		int32 Width = 0;
+		int32 Height = 0;
+		ESampleFormat Format = ESampleFormat::UInt16;
+		int32 BytesPerSample = 2;
+		bool bBigEndian = false;
+
+		// Data chunks (TIFF strips or tiles) as file offsets, row-major
+		TArray<int64> ChunkOffsets;
+		int32 ChunkWidth = 0;
+		int32 ChunkHeight = 0;
+		int32 ChunksAcross = 1;
+
+		// Upper-left corner of pixel (0,0) and pixel size (meters)
+		double OriginE = 0.0;
+		double OriginN = 0.0;
+		double PixelSizeE = 1.0;
+		double PixelSizeN = 1.0;
+
+		// Optional no-data marker (GDAL_NODATA)
+		bool bHasNoData = false;
+		double NoData = 0.0;
+	};
+
+	// Read-only memory mapping of one tile file
+	struct FMappedFile
+	{
+		TUniquePtr<IMappedFileHandle> Handle;
+		TUniquePtr<IMappedFileRegion> Region;
+		const uint8* Data = nullptr;
+		int64 Size = 0;
+
+		bool Open(const FString& Path)
+		{
+			Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+			if (!Handle || Handle->GetFileSize() <= 0)
+				return false;
+
+			Region.Reset(Handle->MapRegion(0, Handle->GetFileSize()));
+			if (!Region)
+				return false;
+
+			Data = Region->GetMappedPtr();
+			Size = Region->GetMappedSize();
+			return Data != nullptr;
+		}
+
+		~FMappedFile()
+		{
+			// Region must be released before its file handle
+			Region.Reset();
+			Handle.Reset();
+		}
+	};
+
+	// Bounds-checked reader for TIFF header structures
+	struct FByteReader
+	{
+		const uint8* Data = nullptr;
+		int64 Size = 0;
+		bool bBigEndian = false;
+		bool bError = false;
+
+		bool InRange(int64 Offset, int64 Bytes)
+		{
+			if (Offset < 0 || Bytes < 0 || Offset + Bytes > Size)
+			{
+				bError = true;
+				return false;
+			}
+			return true;
+		}
+
+		uint16 U16(int64 Offset)
+		{
+			if (!InRange(Offset, 2)) return 0;
+			uint16 V;
+			FMemory::Memcpy(&V, Data + Offset, 2);
+			return bBigEndian ? BYTESWAP_ORDER16(V) : V;
+		}
+
+		uint32 U32(int64 Offset)
+		{
+			if (!InRange(Offset, 4)) return 0;
+			uint32 V;
+			FMemory::Memcpy(&V, Data + Offset, 4);
+			return bBigEndian ? BYTESWAP_ORDER32(V) : V;
+		}
+
+		double F64(int64 Offset)
+		{
+			if (!InRange(Offset, 8)) return 0.0;
+			uint64 Bits;
+			FMemory::Memcpy(&Bits, Data + Offset, 8);
+			if (bBigEndian) Bits = BYTESWAP_ORDER64(Bits);
+			double V;
+			FMemory::Memcpy(&V, &Bits, 8);
+			return V;
+		}
+
+		float F32(int64 Offset)
+		{
+			const uint32 Bits = U32(Offset);
+			float V;
+			FMemory::Memcpy(&V, &Bits, 4);
+			return V;
+		}
+	};
+
+	// TIFF tag ids used by the importer
+	enum ETiffTag : uint16
+	{
+		Tag_ImageWidth      = 256,
+		Tag_ImageLength     = 257,
+		Tag_BitsPerSample   = 258,
+		Tag_Compression     = 259,
+		Tag_StripOffsets    = 273,
+		Tag_SamplesPerPixel = 277,
+		Tag_RowsPerStrip    = 278,
+		Tag_PlanarConfig    = 284,
+		Tag_TileWidth       = 322,
+		Tag_TileLength      = 323,
+		Tag_TileOffsets     = 324,
+		Tag_SampleFormat    = 339,
+		Tag_ModelPixelScale = 33550,
+		Tag_ModelTiepoint   = 33922,
+		Tag_GdalNoData      = 42113
+	};
+
+	// Parse classic (uncompressed) GeoTIFF layout from mapped bytes
+	static bool ParseTiff(const uint8* Data, int64 Size, FRaster& Out, FString& OutError)
+	{
+		if (Size < 8)
+		{
+			OutError = TEXT("file too small");
+			return false;
+		}
+
+		FByteReader R{ Data, Size };
+		if (Data[0] == 'I' && Data[1] == 'I')      R.bBigEndian = false;
+		else if (Data[0] == 'M' && Data[1] == 'M') R.bBigEndian = true;
+		else
+		{
+			OutError = TEXT("not a TIFF file");
+			return false;
+		}
+
+		const uint16 Magic = R.U16(2);
+		if (Magic == 43)
+		{
+			OutError = TEXT("BigTIFF not supported");
+			return false;
+		}
+		if (Magic != 42)
+		{
+			OutError = TEXT("invalid TIFF header");
+			return false;
+		}
+
+		// Read first IFD (numeric tag values as doubles, ASCII separately)
+		const int64 IfdOffset = R.U32(4);
+		const int32 NumEntries = R.U16(IfdOffset);
+
+		TMap<uint16, TArray<double>> Tags;
+		FString NoDataText;
+
+		for (int32 i = 0; i < NumEntries && !R.bError; ++i)
+		{
+			const int64 Entry = IfdOffset + 2 + (int64)i * 12;
+			const uint16 Tag   = R.U16(Entry);
+			const uint16 Type  = R.U16(Entry + 2);
+			const int64  Count = R.U32(Entry + 4);
+
+			int32 TypeSize = 0;
+			switch (Type)
+			{
+			case 2:  TypeSize = 1; break; // ASCII
+			case 3:  TypeSize = 2; break; // SHORT
+			case 4:  TypeSize = 4; break; // LONG
+			case 11: TypeSize = 4; break; // FLOAT
+			case 12: TypeSize = 8; break; // DOUBLE
+			default: continue;            // unused types
+			}
+
+			// Values up to 4 bytes are stored inline
+			const int64 ValueOffset = (Count * TypeSize <= 4) ? Entry + 8 : (int64)R.U32(Entry + 8);
+			if (!R.InRange(ValueOffset, Count * TypeSize))
+				break;
+
+			if (Type == 2)
+			{
+				if (Tag == Tag_GdalNoData)
+				{
+					// Stop at terminating zero
+					int32 Len = 0;
+					while (Len < Count && Data[ValueOffset + Len] != 0) ++Len;
+
+					const FUTF8ToTCHAR Conv((const ANSICHAR*)(Data + ValueOffset), Len);
+					NoDataText = FString(Conv.Length(), Conv.Get()).TrimStartAndEnd();
+				}
+				continue;
+			}
+
+			TArray<double>& Values = Tags.Add(Tag);
+			Values.SetNumUninitialized((int32)Count);
+			for (int32 v = 0; v < Values.Num(); ++v)
+			{
+				const int64 Off = ValueOffset + (int64)v * TypeSize;
+				switch (Type)
+				{
+				case 3:  Values[v] = R.U16(Off); break;
+				case 4:  Values[v] = R.U32(Off); break;
+				case 11: Values[v] = R.F32(Off); break;
+				case 12: Values[v] = R.F64(Off); break;
+				}
+			}
+		}
+
+		if (R.bError)
+		{
+			OutError = TEXT("truncated TIFF directory");
+			return false;
+		}
+
+		// First value of a tag or default
+		auto TagValue = [&Tags](uint16 Tag, double Default) -> double
+		{
+			const TArray<double>* Values = Tags.Find(Tag);
+			return (Values && Values->Num() > 0) ? (*Values)[0] : Default;
+		};
+
+		// Integer tag clamped in double first (LONG values up to 4294967295 do not fit int32)
+		auto TagInt = [&TagValue](uint16 Tag, double Default, double Min = 0.0, double Max = (double)MAX_int32) -> int32
+		{
+			return (int32)FMath::Clamp(TagValue(Tag, Default), Min, Max);
+		};
+
+		Out.Width  = TagInt(Tag_ImageWidth, 0);
+		Out.Height = TagInt(Tag_ImageLength, 0);
+		Out.bBigEndian = R.bBigEndian;
+
+		if (Out.Width <= 0 || Out.Height <= 0)
+		{
+			OutError = TEXT("missing image size");
+			return false;
+		}
+
+		if (TagValue(Tag_Compression, 1) != 1)
+		{
+			OutError = TEXT("compressed TIFF not supported (convert with: gdal_translate -co COMPRESS=NONE)");
+			return false;
+		}
+
+		if (TagValue(Tag_SamplesPerPixel, 1) != 1 || TagValue(Tag_PlanarConfig, 1) != 1)
+		{
+			OutError = TEXT("only single-band rasters supported");
+			return false;
+		}
+
+		// Sample format
+		const int32 Bits = TagInt(Tag_BitsPerSample, 1);
+		const int32 SampleFormat = TagInt(Tag_SampleFormat, 1);
+		if (Bits == 16 && SampleFormat == 1)      Out.Format = ESampleFormat::UInt16;
+		else if (Bits == 16 && SampleFormat == 2) Out.Format = ESampleFormat::Int16;
+		else if (Bits == 32 && SampleFormat == 3) Out.Format = ESampleFormat::Float32;
+		else
+		{
+			OutError = FString::Printf(TEXT("unsupported sample format (%d bit, format %d)"), Bits, SampleFormat);
+			return false;
+		}
+		Out.BytesPerSample = Bits / 8;
+
+		// Chunk layout: tiles or strips
+		const TArray<double>* Offsets = nullptr;
+		int32 ChunksDown = 0;
+		if (const TArray<double>* TileOffsets = Tags.Find(Tag_TileOffsets))
+		{
+			Offsets = TileOffsets;
+			Out.ChunkWidth  = TagInt(Tag_TileWidth, 0);
+			Out.ChunkHeight = TagInt(Tag_TileLength, 0);
+			if (Out.ChunkWidth <= 0 || Out.ChunkHeight <= 0)
+			{
+				OutError = TEXT("invalid tile size");
+				return false;
+			}
+			Out.ChunksAcross = FMath::DivideAndRoundUp(Out.Width, Out.ChunkWidth);
+		}
+		else
+		{
+			Offsets = Tags.Find(Tag_StripOffsets);
+			Out.ChunkWidth  = Out.Width;
+			// Default / single-strip writers: 2^32-1 rows per strip = whole image
+			Out.ChunkHeight = TagInt(Tag_RowsPerStrip, Out.Height, 1.0, (double)Out.Height);
+			Out.ChunksAcross = 1;
+		}
+		ChunksDown = FMath::DivideAndRoundUp(Out.Height, Out.ChunkHeight);
+
+		if (!Offsets || Offsets->Num() < Out.ChunksAcross * ChunksDown)
+		{
+			OutError = TEXT("missing strip/tile offsets");
+			return false;
+		}
+
+		// Validate every chunk lies inside the file (last strip may be shorter)
+		Out.ChunkOffsets.SetNumUninitialized(Out.ChunksAcross * ChunksDown);
+		for (int32 c = 0; c < Out.ChunkOffsets.Num(); ++c)
+		{
+			const int32 ChunkRow = c / Out.ChunksAcross;
+			const int32 Rows = Tags.Contains(Tag_TileOffsets)
+				? Out.ChunkHeight
+				: FMath::Min(Out.ChunkHeight, Out.Height - ChunkRow * Out.ChunkHeight);
+
+			const int64 Offset = (int64)(*Offsets)[c];
+			const int64 Bytes = (int64)Rows * Out.ChunkWidth * Out.BytesPerSample;
+			if (Offset < 0 || Offset + Bytes > Size)
+			{
+				OutError = TEXT("pixel data outside file");
+				return false;
+			}
+			Out.ChunkOffsets[c] = Offset;
+		}
+
+		// Georeference (pixel-is-area: tiepoint marks pixel corner)
+		const TArray<double>* Scale = Tags.Find(Tag_ModelPixelScale);
+		const TArray<double>* Tie = Tags.Find(Tag_ModelTiepoint);
+		if (!Scale || Scale->Num() < 2 || !Tie || Tie->Num() < 6 || (*Scale)[0] <= 0.0 || (*Scale)[1] <= 0.0)
+		{
+			OutError = TEXT("missing GeoTIFF georeference (ModelPixelScale/ModelTiepoint)");
+			return false;
+		}
+		Out.PixelSizeE = (*Scale)[0];
+		Out.PixelSizeN = (*Scale)[1];
+		Out.OriginE = (*Tie)[3] - (*Tie)[0] * Out.PixelSizeE;
+		Out.OriginN = (*Tie)[4] + (*Tie)[1] * Out.PixelSizeN;
+
+		if (!NoDataText.IsEmpty())
+		{
+			Out.bHasNoData = true;
+			Out.NoData = FCString::Atod(*NoDataText);
+		}
+		return true;
+	}
+
+	// Describe 16-bit raw raster from tile settings
+	static bool ParseRaw(const FVoxelDemTileSource& Tile, int64 Size, FRaster& Out, FString& OutError)
+	{
+		if (Tile.RawSize.X <= 0 || Tile.RawSize.Y <= 0 || Tile.RawPixelSizeMeters <= 0.0f)
+		{
+			OutError = TEXT("raw tile needs RawSize and RawPixelSizeMeters");
+			return false;
+		}
+		if ((int64)Tile.RawSize.X * Tile.RawSize.Y * 2 > Size)
+		{
+			OutError = TEXT("raw file smaller than RawSize x 16 bit");
+			return false;
+		}
+
+		Out.Width = Tile.RawSize.X;
+		Out.Height = Tile.RawSize.Y;
+		Out.Format = ESampleFormat::UInt16;
+		Out.BytesPerSample = 2;
+		Out.bBigEndian = false;
+		Out.ChunkOffsets = { 0 };
+		Out.ChunkWidth = Out.Width;
+		Out.ChunkHeight = Out.Height;
+		Out.ChunksAcross = 1;
+		Out.OriginE = Tile.RawGeoOriginMeters.X;
+		Out.OriginN = Tile.RawGeoOriginMeters.Y;
+		Out.PixelSizeE = Tile.RawPixelSizeMeters;
+		Out.PixelSizeN = Tile.RawPixelSizeMeters;
+		return true;
+	}
+
+	// Map tile file and parse its raster layout
+	static bool OpenTile(const FVoxelDemTileSource& Tile, FMappedFile& OutFile, FRaster& OutRaster)
+	{
+		const FString& Path = Tile.File.FilePath;
+		if (!OutFile.Open(Path))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("DEM tile skipped: cannot map file %s"), *Path);
+			return false;
+		}
+
+		FString Error;
+		const FString Ext = FPaths::GetExtension(Path).ToLower();
+		const bool bOk = (Ext == TEXT("tif") || Ext == TEXT("tiff"))
+			? ParseTiff(OutFile.Data, OutFile.Size, OutRaster, Error)
+			: ParseRaw(Tile, OutFile.Size, OutRaster, Error);
+
+		if (!bOk)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("DEM tile skipped: %s (%s)"), *Path, *Error);
+		}
+		return bOk;
+	}
+
+	// Decode one raster row into world Z (cm); no-data becomes -FLT_MAX
+	static void DecodeRow(const FRaster& R, const uint8* Data, int32 Row, double ValueScale, double ValueOffsetMeters, float* OutRow)
+	{
+		const int32 ChunkRow = Row / R.ChunkHeight;
+		const int32 InChunkRow = Row % R.ChunkHeight;
+
+		for (int32 Chunk = 0; Chunk < R.ChunksAcross; ++Chunk)
+		{
+			const int32 Col0 = Chunk * R.ChunkWidth;
+			const int32 Cols = FMath::Min(R.ChunkWidth, R.Width - Col0);
+			const uint8* Src = Data + R.ChunkOffsets[ChunkRow * R.ChunksAcross + Chunk]
+				+ (int64)InChunkRow * R.ChunkWidth * R.BytesPerSample;
+
+			for (int32 i = 0; i < Cols; ++i, Src += R.BytesPerSample)
+			{
+				double V;
+				if (R.Format == ESampleFormat::Float32)
+				{
+					uint32 Bits;
+					FMemory::Memcpy(&Bits, Src, 4);
+					if (R.bBigEndian) Bits = BYTESWAP_ORDER32(Bits);
+					float F;
+					FMemory::Memcpy(&F, &Bits, 4);
+					V = F;
+				}
+				else
+				{
+					uint16 Bits;
+					FMemory::Memcpy(&Bits, Src, 2);
+					if (R.bBigEndian) Bits = BYTESWAP_ORDER16(Bits);
+					V = (R.Format == ESampleFormat::Int16) ? (double)(int16)Bits : (double)Bits;
+				}
+
+				const bool bInvalid = FMath::IsNaN(V) || (R.bHasNoData && V == R.NoData);
+				OutRow[Col0 + i] = bInvalid ? -FLT_MAX : (float)((V * ValueScale + ValueOffsetMeters) * 100.0);
+			}
+		}
+	}
+
+	// Cell range [X, Y] touched by world interval [Min, Max)
+	// Outside grid: empty range (X > Y) that keeps ranges monotonic along the raster axis
+	static FIntPoint CellRange(double Min, double Max, double GridMin, double CellSizeCm, int32 NumCells)
+	{
+		// Shrink slightly so pixels aligned with cell borders do not spill into neighbours
+		const double Eps = (Max - Min) * 1e-3;
+		const int32 First = FMath::FloorToInt32((Min + Eps - GridMin) / CellSizeCm);
+		const int32 Last  = FMath::FloorToInt32((Max - Eps - GridMin) / CellSizeCm);
+		if (Last < 0)
+			return FIntPoint(0, -1);
+		if (First >= NumCells)
+			return FIntPoint(NumCells, NumCells - 1);
+		return FIntPoint(FMath::Max(First, 0), FMath::Min(Last, NumCells - 1));
+	}
+
+	// Reduce one mapped raster into target cells (tasks own whole cell rows: no write races)
+	static int64 ReduceRaster(const FRaster& R, const uint8* Data, const UVoxelGridConfig& Config, FVoxelHeightSnapshot& Target)
+	{
+		const double CellSizeCm = Target.CellSizeCm;
+		const FVector2D GeoOrigin = Config.DemGeoOriginMeters;
+
+		// Raster column -> cell X range (easting -> world X)
+		TArray<FIntPoint> ColCells;
+		ColCells.SetNumUninitialized(R.Width);
+		for (int32 c = 0; c < R.Width; ++c)
+		{
+			const double X0 = (R.OriginE + c * R.PixelSizeE - GeoOrigin.X) * 100.0;
+			ColCells[c] = CellRange(X0, X0 + R.PixelSizeE * 100.0, Target.GridMinWorld.X, CellSizeCm, Target.GridSize.X);
+		}
+
+		// Raster row -> cell Y range (northing decreases with row, world Y increases)
+		TArray<FIntPoint> RowCells;
+		RowCells.SetNumUninitialized(R.Height);
+		int32 CellRowMin = MAX_int32;
+		int32 CellRowMax = -1;
+		for (int32 r = 0; r < R.Height; ++r)
+		{
+			const double Y0 = (GeoOrigin.Y - (R.OriginN - r * R.PixelSizeN)) * 100.0;
+			RowCells[r] = CellRange(Y0, Y0 + R.PixelSizeN * 100.0, Target.GridMinWorld.Y, CellSizeCm, Target.GridSize.Y);
+			if (RowCells[r].X <= RowCells[r].Y)
+			{
+				CellRowMin = FMath::Min(CellRowMin, RowCells[r].X);
+				CellRowMax = FMath::Max(CellRowMax, RowCells[r].Y);
+			}
+		}
+
+		// Guard: raster outside grid
+		if (CellRowMax < CellRowMin)
+			return 0;
+
+		const double ValueScale = Config.DemValueScale;
+		const double ValueOffset = Config.DemValueOffsetMeters;
+		std::atomic<int64> Pixels{0};
+
+		ParallelFor(CellRowMax - CellRowMin + 1, [&](int32 Task)
+		{
+			const int32 CellY = CellRowMin + Task;
+			float* OutRow = Target.MaxHeightCm.GetData() + (int64)CellY * Target.GridSize.X;
+
+			TArray<float> Values;
+			Values.SetNumUninitialized(R.Width);
+			int64 LocalPixels = 0;
+
+			// Raster rows are monotonic in Y: first row reaching this cell row
+			const int32 FirstRow = Algo::LowerBoundBy(RowCells, CellY, [](const FIntPoint& Range) { return Range.Y; });
+
+			for (int32 r = FirstRow; r < R.Height && RowCells[r].X <= CellY; ++r)
+			{
+				if (RowCells[r].Y < CellY)
+					continue;
+
+				DecodeRow(R, Data, r, ValueScale, ValueOffset, Values.GetData());
+
+				for (int32 c = 0; c < R.Width; ++c)
+				{
+					const float Z = Values[c];
+					const FIntPoint Cells = ColCells[c];
+					if (Z <= -1e20f || Cells.X > Cells.Y)
+						continue;
+
+					for (int32 CellX = Cells.X; CellX <= Cells.Y; ++CellX)
+					{
+						OutRow[CellX] = FMath::Max(OutRow[CellX], Z);
+					}
+					LocalPixels++;
+				}
+			}
+
+			Pixels += LocalPixels;
+		});
+
+		return Pixels.load();
+	}
+}
+
+// World XY bounds of all configured tiles
+bool FVoxelDemImporter::ComputeWorldBounds(const UVoxelGridConfig* Config, FBox2D& OutBounds)
+{
+	OutBounds = FBox2D(ForceInit);
+	if (!Config)
+		return false;
+
+	for (const FVoxelDemTileSource& Tile : Config->DemTiles)
+	{
+		VoxelDem::FMappedFile File;
+		VoxelDem::FRaster Raster;
+		if (!VoxelDem::OpenTile(Tile, File, Raster))
+			continue;
+
+		// Upper-left / lower-right pixel corners in world space
+		const FVector2D GeoOrigin = Config->DemGeoOriginMeters;
+		const FVector2D A((Raster.OriginE - GeoOrigin.X) * 100.0, (GeoOrigin.Y - Raster.OriginN) * 100.0);
+		const FVector2D B(A.X + Raster.Width * Raster.PixelSizeE * 100.0, A.Y + Raster.Height * Raster.PixelSizeN * 100.0);
+		OutBounds += A;
+		OutBounds += B;
+	}
+	return OutBounds.bIsValid != 0;
+}
+
+// Stream tiles one by one into target cells
+bool FVoxelDemImporter::ImportTiles(const UVoxelGridConfig* Config, FVoxelHeightSnapshot& Target, int64& OutPixelCount)
+{
+	OutPixelCount = 0;
+
+	// Guard: config + prepared target grid
+	if (!Config || !Target.IsValid())
+		return false;
+
+	int32 ImportedTiles = 0;
+	for (const FVoxelDemTileSource& Tile : Config->DemTiles)
+	{
+		// Mapping lives only while this tile is reduced; OS pages data in on demand
+		VoxelDem::FMappedFile File;
+		VoxelDem::FRaster Raster;
+		if (!VoxelDem::OpenTile(Tile, File, Raster))
+			continue;
+
+		const int64 Pixels = VoxelDem::ReduceRaster(Raster, File.Data, *Config, Target);
+		OutPixelCount += Pixels;
+		ImportedTiles++;
+
+		UE_LOG(LogTemp, Display, TEXT("DEM tile %s: %d x %d px, %lld px inside grid"),
+			*FPaths::GetCleanFilename(Tile.File.FilePath), Raster.Width, Raster.Height, Pixels);
+	}
+	return ImportedTiles > 0;
+}
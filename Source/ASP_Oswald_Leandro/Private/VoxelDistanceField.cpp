@@ -0,0 +1,173 @@
+// Distance field to terrain features on the baked height grid
+// Exact Euclidean distance transform (separable: column pass, then row pass), both passes parallel
+
+#include "VoxelDistanceField.h"
+
+#include "VoxelHeightCache.h"
+#include "Async/ParallelFor.h"
+
+const FName FVoxelDistanceField::DistanceChannel(TEXT("FeatureDistance"));
+
+namespace VoxelDistance
+{
+	// Column distance for "no feature in this column"
+	static constexpr int32 Unreached = MAX_int32;
+
+	// Slope (rise/run) at a cell from central differences (one-sided at borders and holes)
+	static float CellSlope(const float* Heights, int32 SizeX, int32 SizeY, int32 X, int32 Y, float CellSizeCm)
+	{
+		const float Z = Heights[X + Y * SizeX];
+
+		auto Gradient = [&](int32 Ax, int32 Ay, int32 Bx, int32 By)
+		{
+			const bool bA = Ax >= 0 && Ay >= 0 && Ax < SizeX && Ay < SizeY && Heights[Ax + Ay * SizeX] > -1e20f;
+			const bool bB = Bx >= 0 && By >= 0 && Bx < SizeX && By < SizeY && Heights[Bx + By * SizeX] > -1e20f;
+			if (bA && bB) return (Heights[Bx + By * SizeX] - Heights[Ax + Ay * SizeX]) / (2.0f * CellSizeCm);
+			if (bB)       return (Heights[Bx + By * SizeX] - Z) / CellSizeCm;
+			if (bA)       return (Z - Heights[Ax + Ay * SizeX]) / CellSizeCm;
+			return 0.0f;
+		};
+
+		const float GX = Gradient(X - 1, Y, X + 1, Y);
+		const float GY = Gradient(X, Y - 1, X, Y + 1);
+		return FMath::Sqrt(GX * GX + GY * GY);
+	}
+}
+
+// Felzenszwalb/Huttenlocher: 1D column distances, then lower envelope of parabolas per row
+bool FVoxelDistanceField::Compute(const FVoxelHeightSnapshot& Snapshot, const FVoxelDistanceFieldSettings& Settings, TArray<float>& OutDistanceCm, int64& OutFeatureCells)
+{
+	OutFeatureCells = 0;
+
+	// Guard: baked grid
+	if (!Snapshot.IsValid())
+		return false;
+
+	const int32 SizeX = Snapshot.GridSize.X;
+	const int32 SizeY = Snapshot.GridSize.Y;
+	const int32 NumCells = SizeX * SizeY;
+	const float* Heights = Snapshot.MaxHeightCm.GetData();
+	const float CellSizeCm = Snapshot.CellSizeCm;
+
+	const bool bSlope = Settings.Feature == EVoxelDistanceFeature::SlopeAbove;
+	const float Threshold = bSlope
+		? FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(Settings.SlopeDegrees, 0.0f, 89.9f)))
+		: Settings.HeightThresholdWorldZCm;
+
+	// Pass 1: per column, distance (cells) to nearest feature in the same column
+	TArray<int32> ColumnDist;
+	ColumnDist.SetNumUninitialized(NumCells);
+	int32* G = ColumnDist.GetData();
+
+	TArray<int64> FeaturesPerColumn;
+	FeaturesPerColumn.SetNumZeroed(SizeX);
+
+	ParallelFor(SizeX, [&](int32 X)
+	{
+		int64 Features = 0;
+
+		// Downward sweep: distance to feature above (or at) each cell
+		int32 Dist = VoxelDistance::Unreached;
+		for (int32 Y = 0; Y < SizeY; ++Y)
+		{
+			const float Z = Heights[X + Y * SizeX];
+			bool bFeature = false;
+			if (Z > -1e20f)
+			{
+				bFeature = bSlope
+					? VoxelDistance::CellSlope(Heights, SizeX, SizeY, X, Y, CellSizeCm) >= Threshold
+					: Z >= Threshold;
+			}
+
+			if (bFeature)
+			{
+				Dist = 0;
+				Features++;
+			}
+			else if (Dist != VoxelDistance::Unreached)
+			{
+				Dist++;
+			}
+			G[X + Y * SizeX] = Dist;
+		}
+
+		// Upward sweep: feature below may be closer
+		for (int32 Y = SizeY - 2; Y >= 0; --Y)
+		{
+			const int32 Below = G[X + (Y + 1) * SizeX];
+			if (Below != VoxelDistance::Unreached && Below + 1 < G[X + Y * SizeX])
+			{
+				G[X + Y * SizeX] = Below + 1;
+			}
+		}
+
+		FeaturesPerColumn[X] = Features;
+	});
+
+	for (const int64 Count : FeaturesPerColumn)
+	{
+		OutFeatureCells += Count;
+	}
+
+	OutDistanceCm.SetNumUninitialized(NumCells);
+	float* Out = OutDistanceCm.GetData();
+
+	// Pass 2: per row, D(x) = min_q (x - q)^2 + G(q)^2 via lower envelope of parabolas
+	ParallelFor(SizeY, [&](int32 Y)
+	{
+		const int32* Row = G + Y * SizeX;
+
+		TArray<int32> V;     // parabola apex positions
+		TArray<double> Zb;   // left boundary of each parabola's envelope range
+		V.SetNumUninitialized(SizeX);
+		Zb.SetNumUninitialized(SizeX);
+
+		auto F = [&](int32 Q) { return (double)Row[Q] * (double)Row[Q]; };
+
+		int32 K = -1;
+		for (int32 Q = 0; Q < SizeX; ++Q)
+		{
+			// Columns without features contribute no parabola
+			if (Row[Q] == VoxelDistance::Unreached)
+				continue;
+
+			double S = -DBL_MAX;
+			while (K >= 0)
+			{
+				S = ((F(Q) + (double)Q * Q) - (F(V[K]) + (double)V[K] * V[K])) / (2.0 * (Q - V[K]));
+				if (S <= Zb[K])
+				{
+					K--;
+					S = -DBL_MAX;
+				}
+				else
+				{
+					break;
+				}
+			}
+			K++;
+			V[K] = Q;
+			Zb[K] = S;
+		}
+
+		float* OutRow = Out + Y * SizeX;
+		if (K < 0)
+		{
+			for (int32 X = 0; X < SizeX; ++X) OutRow[X] = FLT_MAX;
+			return;
+		}
+
+		int32 J = 0;
+		for (int32 X = 0; X < SizeX; ++X)
+		{
+			while (J < K && Zb[J + 1] < (double)X)
+			{
+				J++;
+			}
+			const double DX = (double)(X - V[J]);
+			OutRow[X] = (float)FMath::Sqrt(DX * DX + F(V[J])) * CellSizeCm;
+		}
+	});
+
+	return true;
+}
@@ -0,0 +1,200 @@
+// Sea-level inundation analysis on the baked height grid
+// Finds connected flooded regions for a water level and per-cell water depth
+
+#include "VoxelFloodAnalysis.h"
+
+#include "VoxelHeightCache.h"
+#include "Async/ParallelFor.h"
+
+const FName FVoxelFloodAnalysis::WaterDepthChannel(TEXT("WaterDepth"));
+const FName FVoxelFloodAnalysis::FloodRegionChannel(TEXT("FloodRegion"));
+
+namespace VoxelFlood
+{
+	// Union-find root with path halving (parents always point to smaller indices)
+	static int32 FindRoot(int32* Parent, int32 i)
+	{
+		while (Parent[i] != i)
+		{
+			Parent[i] = Parent[Parent[i]];
+			i = Parent[i];
+		}
+		return i;
+	}
+
+	// Join two wet cells; smaller index becomes root (deterministic labels)
+	static void Union(int32* Parent, int32 A, int32 B)
+	{
+		const int32 RootA = FindRoot(Parent, A);
+		const int32 RootB = FindRoot(Parent, B);
+		if (RootA < RootB)      Parent[RootB] = RootA;
+		else if (RootB < RootA) Parent[RootA] = RootB;
+	}
+}
+
+// Tile-parallel connected components over wet cells, then seed reachability
+bool FVoxelFloodAnalysis::Run(const FVoxelHeightSnapshot& Snapshot, const FVoxelFloodSettings& Settings, FVoxelFloodResult& OutResult)
+{
+	OutResult = FVoxelFloodResult();
+
+	// Guard: baked grid
+	if (!Snapshot.IsValid())
+		return false;
+
+	const int32 SizeX = Snapshot.GridSize.X;
+	const int32 SizeY = Snapshot.GridSize.Y;
+	const int32 NumCells = SizeX * SizeY;
+	const float Level = Settings.WaterLevelWorldZCm;
+	const float* Heights = Snapshot.MaxHeightCm.GetData();
+
+	const int32 TileSize = FMath::Max(8, Settings.TileSize);
+	const int32 TilesX = FMath::DivideAndRoundUp(SizeX, TileSize);
+	const int32 TilesY = FMath::DivideAndRoundUp(SizeY, TileSize);
+
+	// Union-find parent per cell (-1 = dry; cells without terrain count as open water, e.g. grid padding)
+	TArray<int32> ParentArray;
+	ParentArray.SetNumUninitialized(NumCells);
+	int32* Parent = ParentArray.GetData();
+
+	// Pass 1: label wet cells inside each tile (tile-local unions only: no races)
+	ParallelFor(TilesX * TilesY, [&](int32 Tile)
+	{
+		const int32 X0 = (Tile % TilesX) * TileSize;
+		const int32 Y0 = (Tile / TilesX) * TileSize;
+		const int32 X1 = FMath::Min(X0 + TileSize, SizeX);
+		const int32 Y1 = FMath::Min(Y0 + TileSize, SizeY);
+
+		for (int32 Y = Y0; Y < Y1; ++Y)
+		{
+			for (int32 X = X0; X < X1; ++X)
+			{
+				const int32 Idx = X + Y * SizeX;
+				const float Z = Heights[Idx];
+				const bool bWet = Z <= -1e20f || Z < Level;
+				Parent[Idx] = bWet ? Idx : -1;
+
+				if (!bWet)
+					continue;
+
+				// 4-connectivity to already labeled neighbours in this tile
+				if (X > X0 && Parent[Idx - 1] >= 0)     VoxelFlood::Union(Parent, Idx, Idx - 1);
+				if (Y > Y0 && Parent[Idx - SizeX] >= 0) VoxelFlood::Union(Parent, Idx, Idx - SizeX);
+			}
+		}
+	});
+
+	// Pass 2: merge components across tile borders (only border cells, serial)
+	for (int32 TX = 1; TX < TilesX; ++TX)
+	{
+		const int32 X = TX * TileSize;
+		for (int32 Y = 0; Y < SizeY; ++Y)
+		{
+			const int32 Idx = X + Y * SizeX;
+			if (Parent[Idx] >= 0 && Parent[Idx - 1] >= 0)
+			{
+				VoxelFlood::Union(Parent, Idx, Idx - 1);
+			}
+		}
+	}
+	for (int32 TY = 1; TY < TilesY; ++TY)
+	{
+		const int32 Y = TY * TileSize;
+		for (int32 X = 0; X < SizeX; ++X)
+		{
+			const int32 Idx = X + Y * SizeX;
+			if (Parent[Idx] >= 0 && Parent[Idx - SizeX] >= 0)
+			{
+				VoxelFlood::Union(Parent, Idx, Idx - SizeX);
+			}
+		}
+	}
+
+	// Pass 3: components reachable from seeds get compact region ids (ordered by root index)
+	TArray<int32> RootRegion;
+	RootRegion.Init(-1, NumCells);
+
+	TArray<int32> SeedRoots;
+	auto AddSeed = [&](int32 X, int32 Y)
+	{
+		const int32 Idx = X + Y * SizeX;
+		if (Parent[Idx] < 0)
+			return;
+
+		const int32 Root = VoxelFlood::FindRoot(Parent, Idx);
+		if (RootRegion[Root] == -1)
+		{
+			RootRegion[Root] = 0;
+			SeedRoots.Add(Root);
+		}
+	};
+
+	if (Settings.bSeedFromBorder)
+	{
+		for (int32 X = 0; X < SizeX; ++X)
+		{
+			AddSeed(X, 0);
+			AddSeed(X, SizeY - 1);
+		}
+		for (int32 Y = 0; Y < SizeY; ++Y)
+		{
+			AddSeed(0, Y);
+			AddSeed(SizeX - 1, Y);
+		}
+	}
+	for (const FIntPoint& Seed : Settings.SeedCells)
+	{
+		if (Snapshot.IsValidCell(Seed.X, Seed.Y))
+		{
+			AddSeed(Seed.X, Seed.Y);
+		}
+	}
+
+	SeedRoots.Sort();
+	for (int32 i = 0; i < SeedRoots.Num(); ++i)
+	{
+		RootRegion[SeedRoots[i]] = i;
+	}
+	OutResult.NumRegions = SeedRoots.Num();
+
+	// Flatten: parents point to smaller indices, so one ascending pass makes every parent a root
+	for (int32 Idx = 0; Idx < NumCells; ++Idx)
+	{
+		if (Parent[Idx] >= 0)
+		{
+			Parent[Idx] = Parent[Parent[Idx]];
+		}
+	}
+
+	// Pass 4: per-cell region + depth (read-only root lookup, parallel per row)
+	OutResult.RegionId.SetNumUninitialized(NumCells);
+	OutResult.WaterDepthCm.SetNumUninitialized(NumCells);
+	int32* OutRegion = OutResult.RegionId.GetData();
+	float* OutDepth = OutResult.WaterDepthCm.GetData();
+
+	TArray<int64> FloodedPerRow;
+	FloodedPerRow.SetNumZeroed(SizeY);
+
+	ParallelFor(SizeY, [&](int32 Y)
+	{
+		int64 Flooded = 0;
+		for (int32 X = 0; X < SizeX; ++X)
+		{
+			const int32 Idx = X + Y * SizeX;
+
+			const int32 Region = Parent[Idx] >= 0 ? RootRegion[Parent[Idx]] : -1;
+			const bool bTerrain = Heights[Idx] > -1e20f;
+
+			// No-data water cells carry the region but have no depth and are not counted
+			OutRegion[Idx] = Region;
+			OutDepth[Idx] = Region >= 0 && bTerrain ? Level - Heights[Idx] : 0.0f;
+			Flooded += Region >= 0 && bTerrain ? 1 : 0;
+		}
+		FloodedPerRow[Y] = Flooded;
+	});
+
+	for (const int64 Count : FloodedPerRow)
+	{
+		OutResult.FloodedCells += Count;
+	}
+	return true;
+}
@@ -10,6 +10,15 @@
 #include "VoxelHeightCache.h"
 #include "Engine/StaticMesh.h"
 #include "HeightQueryProbeActor.h"
+#include "VoxelBakeStore.h"
+#include "VoxelDemImporter.h"
+#include "VoxelFloodAnalysis.h"
+#include "VoxelViewshed.h"
+#include "VoxelPathfinder.h"
+#include "VoxelDistanceField.h"
+#include "VoxelHorizonMap.h"
+#include "Async/Async.h"
+#include "Engine/World.h"
 
 
 // Sets default values
@@ -58,32 +67,47 @@ void AVoxelGridBaker::BuildGrid()
 		return;
 	}
 
+	BuildGridFromBounds(LMin, LMax);
+}
+
+// Grid extents and resolution from world-space bounds (config cell size + padding)
+bool AVoxelGridBaker::BuildGridFromBounds(const FVector& LMin, const FVector& LMax)
+{
+	if (!ComputeGridFromBounds(LMin, LMax, GridMinWorld, GridMaxWorld, GridSize, CellSizeCm))
+		return false;
+
+	const int32 TotalCells = GridSize.X * GridSize.Y;
+
+	UE_LOG(LogTemp, Display, TEXT("Grid Built: Size=%d x %d (Cells=%d), CellSize=%.2fm"),
+		GridSize.X, GridSize.Y, TotalCells, GridConfig->CellSizeMeters);
+	return true;
+}
+
+bool AVoxelGridBaker::ComputeGridFromBounds(const FVector& LMin, const FVector& LMax,
+	FVector& OutMinWorld, FVector& OutMaxWorld, FIntPoint& OutSize, float& OutCellSizeCm) const
+{
 	// Config meters -> cm
-	CellSizeCm = GridConfig->CellSizeMeters * 100.0f;
-	if (CellSizeCm <= 0.0f)
+	OutCellSizeCm = GridConfig->CellSizeMeters * 100.0f;
+	if (OutCellSizeCm <= 0.0f)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("BuildGrid failed: CellSizeMeters must be > 0"));
-		return;
+		return false;
 	}
 
-	// Optional padding around landscape bounds
+	// Optional padding around bounds
 	const float PaddingCm = GridConfig->PaddingMeters * 100.0f;
 
-	// Grid XY covers padded landscape area
-	GridMinWorld = FVector(LMin.X - PaddingCm, LMin.Y - PaddingCm, 0.0f);
-	GridMaxWorld = FVector(LMax.X + PaddingCm, LMax.Y + PaddingCm, 0.0f);
+	// Grid XY covers padded area
+	OutMinWorld = FVector(LMin.X - PaddingCm, LMin.Y - PaddingCm, 0.0f);
+	OutMaxWorld = FVector(LMax.X + PaddingCm, LMax.Y + PaddingCm, 0.0f);
 
-	const float WidthCm  = GridMaxWorld.X - GridMinWorld.X;
-	const float HeightCm = GridMaxWorld.Y - GridMinWorld.Y;
+	const float WidthCm  = OutMaxWorld.X - OutMinWorld.X;
+	const float HeightCm = OutMaxWorld.Y - OutMinWorld.Y;
 
 	// Resolution: ceil to fully cover bounds
-	GridSize.X = FMath::Max(1, FMath::CeilToInt(WidthCm  / CellSizeCm));
-	GridSize.Y = FMath::Max(1, FMath::CeilToInt(HeightCm / CellSizeCm));
-
-	const int32 TotalCells = GridSize.X * GridSize.Y;
-
-	UE_LOG(LogTemp, Display, TEXT("Grid Built: Size=%d x %d (Cells=%d), CellSize=%.2fm"),
-		GridSize.X, GridSize.Y, TotalCells, GridConfig->CellSizeMeters);
+	OutSize.X = FMath::Max(1, FMath::CeilToInt(WidthCm  / OutCellSizeCm));
+	OutSize.Y = FMath::Max(1, FMath::CeilToInt(HeightCm / OutCellSizeCm));
+	return true;
 }
 
 // Draw the grid outer border as debug lines
@@ -155,6 +179,277 @@ void AVoxelGridBaker::DebugDrawSomeCells50()
 	DebugDrawSomeCells(1000);
 }
 
+namespace VoxelTraceBake
+{
+	// Bake inputs (copied on the game thread)
+	struct FJob
+	{
+		// Not owned: world cleanup cancels the bake and waits for the worker before the scene goes away
+		UWorld* World = nullptr;
+		FCollisionQueryParams Params;
+		TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+		FVector GridMinWorld = FVector::ZeroVector;
+		FIntPoint GridSize = FIntPoint(0, 0);
+		float CellSizeCm = 0.0f;
+		float LandscapeZ = 0.0f;
+		float TraceStartCm = 0.0f;
+		float TraceEndCm = 0.0f;
+		int32 SamplesPerAxis = 1;
+		bool bAdaptive = false;
+		int32 MaxDepth = 0;
+		float ToleranceCm = 0.0f;
+		bool bReportError = false;
+	};
+
+	// Bake counters reported back to the game thread
+	struct FStats
+	{
+		int64 TraceCount = 0;
+		int64 HitCount = 0;
+		int64 ReferenceTraces = 0;
+		int64 ReferenceHits = 0;
+		float MaxErrorCm = 0.0f;
+		bool bAborted = false;
+
+		// Previous snapshot had the same layout (per-cell channels stay addressable)
+		bool bSameLayout = false;
+
+		// Bounding rect of cells whose height changed vs. the previous snapshot (empty = none)
+		FIntRect ChangedCells;
+	};
+
+	// Compare fresh bake with the snapshot it replaces (full grid if the layout changed)
+	static void FindChangedCells(const FVoxelHeightSnapshot& Prev, const FVoxelHeightSnapshot& Next, FStats& Stats)
+	{
+		Stats.bSameLayout = Prev.IsValid() && Prev.GridSize == Next.GridSize
+			&& Prev.CellSizeCm == Next.CellSizeCm && Prev.GridMinWorld.Equals(Next.GridMinWorld);
+		if (!Stats.bSameLayout)
+		{
+			Stats.ChangedCells = FIntRect(FIntPoint(0, 0), Next.GridSize);
+			return;
+		}
+
+		FIntPoint Min(MAX_int32, MAX_int32);
+		FIntPoint Max(MIN_int32, MIN_int32);
+		for (int32 Y = 0; Y < Next.GridSize.Y; ++Y)
+		{
+			for (int32 X = 0; X < Next.GridSize.X; ++X)
+			{
+				const int32 Idx = Next.ToIndex(X, Y);
+				if (Prev.MaxHeightCm[Idx] != Next.MaxHeightCm[Idx])
+				{
+					Min = FIntPoint(FMath::Min(Min.X, X), FMath::Min(Min.Y, Y));
+					Max = FIntPoint(FMath::Max(Max.X, X), FMath::Max(Max.Y, Y));
+				}
+			}
+		}
+		Stats.ChangedCells = Min.X <= Max.X ? FIntRect(Min, Max + FIntPoint(1, 1)) : FIntRect();
+	}
+
+	// Trace all cells into Out on a pool thread (read-only scene queries; world kept alive by the cleanup hook)
+	static void Run(const FJob& Job, const UVoxelHeightCache& Cache, FVoxelHeightSnapshot& Out, FStats& Stats)
+	{
+		const FVector GridMinWorld = Job.GridMinWorld;
+		const FIntPoint GridSize = Job.GridSize;
+		const float CellSizeCm = Job.CellSizeCm;
+		const int32 SamplesPerAxis = Job.SamplesPerAxis;
+
+		UWorld* World = Job.World;
+
+		// Trace vertical line at world XY: above -> below landscape
+		auto TraceSurfaceZ = [&](float SampleX, float SampleY, float& OutZ) -> bool
+		{
+			const FVector Start(SampleX, SampleY, Job.LandscapeZ + Job.TraceStartCm);
+			const FVector End  (SampleX, SampleY, Job.LandscapeZ - Job.TraceEndCm);
+
+			FHitResult Hit;
+			const bool bHit = World->LineTraceSingleByChannel(
+				Hit,
+				Start,
+				End,
+				Job.TraceChannel,
+				Job.Params
+			);
+
+			Stats.TraceCount++;
+			if (bHit)
+			{
+				Stats.HitCount++;
+				OutZ = Hit.Location.Z;
+			}
+			return bHit;
+		};
+
+		// Stop between rows once the write was cancelled (world cleanup, cache reload)
+		auto BeginRow = [&]() -> bool
+		{
+			Stats.bAborted = Cache.IsWriteCancelled();
+			return !Stats.bAborted;
+		};
+
+		// Fixed pattern: sub-sample points inside cell (center of sub-cells)
+		auto BakeCellFixed = [&](int32 X, int32 Y) -> float
+		{
+			float MaxZ = -FLT_MAX;
+
+			// Cell origin in world space
+			const float CellMinX = GridMinWorld.X + (float)X * CellSizeCm;
+			const float CellMinY = GridMinWorld.Y + (float)Y * CellSizeCm;
+
+			for (int32 sy = 0; sy < SamplesPerAxis; ++sy)
+			{
+				for (int32 sx = 0; sx < SamplesPerAxis; ++sx)
+				{
+					const float U = ((float)sx + 0.5f) / (float)SamplesPerAxis; // 0..1
+					const float V = ((float)sy + 0.5f) / (float)SamplesPerAxis;
+
+					// Track highest hit inside this cell
+					float Z;
+					if (TraceSurfaceZ(CellMinX + U * CellSizeCm, CellMinY + V * CellSizeCm, Z))
+					{
+						MaxZ = FMath::Max(MaxZ, Z);
+					}
+				}
+			}
+			return MaxZ;
+		};
+
+		if (!Job.bAdaptive)
+		{
+			// Iterate over all grid cells
+			for (int32 Y = 0; Y < GridSize.Y; ++Y)
+			{
+				if (!BeginRow())
+					return;
+
+				for (int32 X = 0; X < GridSize.X; ++X)
+				{
+					// Store max height (world Z in cm) for this cell
+					Out.MaxHeightCm[Out.ToIndex(X, Y)] = BakeCellFixed(X, Y);
+				}
+			}
+			return;
+		}
+
+		// Adaptive: quad corners + center per cell, refine quads whose samples disagree
+		const int32 MaxDepth = Job.MaxDepth;
+		const float ToleranceCm = Job.ToleranceCm;
+
+		// Sample lattice: 2^(MaxDepth+1) steps per cell so finest quad centers lie on it
+		const int32 LatticePerCell = 1 << (MaxDepth + 1);
+		const int64 LatticeRowStride = (int64)GridSize.X * LatticePerCell + 1;
+		const float LatticeStepCm = CellSizeCm / (float)LatticePerCell;
+
+		// Traced lattice points (shared along cell borders between neighbours)
+		TMap<int64, float> LatticeZ;
+
+		auto SampleLattice = [&](int32 LX, int32 LY) -> float
+		{
+			const int64 Key = (int64)LY * LatticeRowStride + LX;
+			if (const float* Found = LatticeZ.Find(Key))
+				return *Found;
+
+			float Z = -FLT_MAX;
+			TraceSurfaceZ(GridMinWorld.X + (float)LX * LatticeStepCm, GridMinWorld.Y + (float)LY * LatticeStepCm, Z);
+			LatticeZ.Add(Key, Z);
+			return Z;
+		};
+
+		// Quad to refine: lattice min corner, size (lattice steps), depth
+		struct FQuad { int32 LX, LY, Size, Depth; };
+		TArray<FQuad> Stack;
+
+		for (int32 Y = 0; Y < GridSize.Y; ++Y)
+		{
+			if (!BeginRow())
+				return;
+
+			for (int32 X = 0; X < GridSize.X; ++X)
+			{
+				float MaxZ = -FLT_MAX;
+
+				Stack.Reset();
+				Stack.Add({ X * LatticePerCell, Y * LatticePerCell, LatticePerCell, 0 });
+
+				while (Stack.Num() > 0)
+				{
+					const FQuad Q = Stack.Pop(EAllowShrinking::No);
+					const int32 Half = Q.Size / 2;
+
+					const float Samples[5] = {
+						SampleLattice(Q.LX,          Q.LY),
+						SampleLattice(Q.LX + Q.Size, Q.LY),
+						SampleLattice(Q.LX,          Q.LY + Q.Size),
+						SampleLattice(Q.LX + Q.Size, Q.LY + Q.Size),
+						SampleLattice(Q.LX + Half,   Q.LY + Half)
+					};
+
+					// Spread of samples (a miss next to a hit always refines)
+					float QuadMin = FLT_MAX;
+					float QuadMax = -FLT_MAX;
+					for (const float Z : Samples)
+					{
+						QuadMin = FMath::Min(QuadMin, Z);
+						QuadMax = FMath::Max(QuadMax, Z);
+					}
+					MaxZ = FMath::Max(MaxZ, QuadMax);
+
+					const bool bMixedHits = QuadMin <= -1e20f && QuadMax > -1e20f;
+					if (Q.Depth < MaxDepth && (bMixedHits || QuadMax - QuadMin > ToleranceCm))
+					{
+						Stack.Add({ Q.LX,        Q.LY,        Half, Q.Depth + 1 });
+						Stack.Add({ Q.LX + Half, Q.LY,        Half, Q.Depth + 1 });
+						Stack.Add({ Q.LX,        Q.LY + Half, Half, Q.Depth + 1 });
+						Stack.Add({ Q.LX + Half, Q.LY + Half, Half, Q.Depth + 1 });
+					}
+				}
+
+				Out.MaxHeightCm[Out.ToIndex(X, Y)] = MaxZ;
+
+				// Optional: compare against every lattice point of the cell (what full refinement would see)
+				if (Job.bReportError)
+				{
+					const int64 TracesBefore = Stats.TraceCount;
+					const int64 HitsBefore = Stats.HitCount;
+
+					float ReferenceZ = -FLT_MAX;
+					for (int32 LY = 0; LY <= LatticePerCell; ++LY)
+					{
+						for (int32 LX = 0; LX <= LatticePerCell; ++LX)
+						{
+							float Z;
+							if (TraceSurfaceZ(GridMinWorld.X + (float)(X * LatticePerCell + LX) * LatticeStepCm,
+								GridMinWorld.Y + (float)(Y * LatticePerCell + LY) * LatticeStepCm, Z))
+							{
+								ReferenceZ = FMath::Max(ReferenceZ, Z);
+							}
+						}
+					}
+
+					// Reference traces are debug overhead, not part of the bake
+					Stats.ReferenceTraces += Stats.TraceCount - TracesBefore;
+					Stats.ReferenceHits += Stats.HitCount - HitsBefore;
+
+					if (ReferenceZ > -1e20f && MaxZ > -1e20f)
+					{
+						Stats.MaxErrorCm = FMath::Max(Stats.MaxErrorCm, FMath::Abs(MaxZ - ReferenceZ));
+					}
+				}
+			}
+
+			// Lattice rows above the next cell row are never sampled again
+			const int64 FirstKeptKey = (int64)(Y + 1) * LatticePerCell * LatticeRowStride;
+			for (auto It = LatticeZ.CreateIterator(); It; ++It)
+			{
+				if (It.Key() < FirstKeptKey)
+				{
+					It.RemoveCurrent();
+				}
+			}
+		}
+	}
+}
+
 // Bake per-cell maximum Z by sampling line traces inside each cell
 void AVoxelGridBaker::BakeMaxHeights()
 {
@@ -165,6 +460,13 @@ void AVoxelGridBaker::BakeMaxHeights()
 		return;
 	}
 
+	// Guard: one writer per cache (a bake from any baker owns the back buffer)
+	if (HeightCache->IsWriteInProgress())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("BakeMaxHeights failed: a bake into this HeightCache is still running."));
+		return;
+	}
+
 	// Guard: grid built first
 	if (!IsGridValid())
 	{
@@ -180,84 +482,640 @@ void AVoxelGridBaker::BakeMaxHeights()
 		return;
 	}
 
-	// Init cache metadata + storage
-	HeightCache->GridMinWorld = GridMinWorld;
-	HeightCache->CellSizeCm = CellSizeCm;
-	HeightCache->Allocate(GridSize.X, GridSize.Y);
+	// Content hash over landscape heights, config and grid layout (empty = heights unreadable, no store)
+	const FString BakeHash = GridConfig->bUseBakeCache
+		? FVoxelBakeStore::ComputeBakeHash(Landscape, GridConfig, GridMinWorld, GridSize, CellSizeCm)
+		: FString();
+	const bool bUseBakeCache = !BakeHash.IsEmpty();
 
-	// Sampling density per cell
-	const int32 SamplesPerAxis = FMath::Max(1, GridConfig->SamplesPerAxis);
-	const int32 SamplesTotal = SamplesPerAxis * SamplesPerAxis;
+	if (bUseBakeCache)
+	{
+		// Cache already holds this exact bake: no traces, but channel settings are not part of the hash
+		if (HeightCache->IsValid() && HeightCache->BakeHash == BakeHash)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Bake skipped: HeightCache up to date (Hash=%s)"), *BakeHash);
+			RefreshDerivedChannels(FIntRect());
+#if WITH_EDITOR
+			HeightCache->Modify();
+#endif
+			return;
+		}
 
-	// Trace range (meters -> cm)
-	const float TraceStartCm = GridConfig->TraceStartAboveMeters * 100.0f;
-	const float TraceEndCm   = GridConfig->TraceEndBelowMeters * 100.0f;
+		// Reuse matching result from local bake store
+		if (FVoxelBakeStore::Load(BakeHash, HeightCache))
+		{
+#if WITH_EDITOR
+			HeightCache->Modify();
+#endif
+			RefreshDerivedData(FIntRect(FIntPoint(0, 0), HeightCache->GridSize));
+			UE_LOG(LogTemp, Display, TEXT("Bake loaded from store (Hash=%s), Cells=%d"),
+				*BakeHash, GridSize.X * GridSize.Y);
+			return;
+		}
+	}
+
+	// Trace inputs copied here: the worker never touches baker or config objects
+	VoxelTraceBake::FJob Job;
+	Job.World = GetWorld();
+	Job.Params = FCollisionQueryParams(SCENE_QUERY_STAT(VoxelBakeTrace), true);
+	Job.Params.bReturnPhysicalMaterial = false;
+	Job.Params.AddIgnoredActor(this);
+	Job.TraceChannel = GridConfig->TraceChannel;
+	Job.GridMinWorld = GridMinWorld;
+	Job.GridSize = GridSize;
+	Job.CellSizeCm = CellSizeCm;
+	Job.LandscapeZ = Landscape->GetActorLocation().Z;
+	Job.TraceStartCm = GridConfig->TraceStartAboveMeters * 100.0f;
+	Job.TraceEndCm = GridConfig->TraceEndBelowMeters * 100.0f;
+	Job.SamplesPerAxis = FMath::Max(1, GridConfig->SamplesPerAxis);
+	Job.bAdaptive = GridConfig->bAdaptiveSampling;
+	Job.MaxDepth = FMath::Clamp(GridConfig->AdaptiveMaxDepth, 0, 6);
+	Job.ToleranceCm = FMath::Max(0.0f, GridConfig->AdaptiveToleranceMeters * 100.0f);
+	Job.bReportError = GridConfig->bAdaptiveReportError;
+
+	// Bake into back buffer; queries keep reading the previous snapshot until publish
+	FVoxelHeightSnapshot* Target = HeightCache->BeginWrite();
+	if (!Target)
+		return;
 
-	// Trace params: ignore baker actor
-	FCollisionQueryParams Params(SCENE_QUERY_STAT(VoxelBakeTrace), true);
-	Params.bReturnPhysicalMaterial = false;
-	Params.AddIgnoredActor(this);
+	Target->Reset(GridMinWorld, GridSize, CellSizeCm);
 
-	int32 HitCount = 0;
-	const int32 TotalCells = GridSize.X * GridSize.Y;
+	// Cache must outlive the worker writing its back buffer
+	HeightCache->AddToRoot();
+
+	UE_LOG(LogTemp, Display, TEXT("Bake started in background. Cells=%d"), GridSize.X * GridSize.Y);
 
-	// Iterate over all grid cells
-	for (int32 Y = 0; Y < GridSize.Y; ++Y)
+	TWeakObjectPtr<AVoxelGridBaker> WeakThis(this);
+	UVoxelHeightCache* Cache = HeightCache;
+	const uint32 WriteId = Cache->GetWriteId();
+
+	// Map close / level switch / PIE end: cancel and block until no trace runs against the world
+	const FDelegateHandle CleanupHandle = FWorldDelegates::OnWorldCleanup.AddLambda(
+		[World = Job.World, Cache, WriteId](UWorld* CleanedWorld, bool, bool)
+		{
+			if (CleanedWorld == World && Cache->OwnsWrite(WriteId))
+			{
+				Cache->CancelWrite();
+			}
+		});
+
+	Cache->SetWriteTask(Async(EAsyncExecution::ThreadPool, [WeakThis, Cache, WriteId, Target, Job, BakeHash, bUseBakeCache, CleanupHandle]()
 	{
-		for (int32 X = 0; X < GridSize.X; ++X)
+		VoxelTraceBake::FStats Stats;
+		VoxelTraceBake::Run(Job, *Cache, *Target, Stats);
+
+		// Front is stable while this write owns the cache
+		if (!Stats.bAborted)
 		{
-			float MaxZ = -FLT_MAX;
+			FVoxelHeightReadScope Scope(*Cache);
+			VoxelTraceBake::FindChangedCells(Scope.Get(), *Target, Stats);
+		}
 
-			// Cell origin in world space
-			const float CellMinX = GridMinWorld.X + (float)X * CellSizeCm;
-			const float CellMinY = GridMinWorld.Y + (float)Y * CellSizeCm;
+		// Publish + derived data on the game thread
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Cache, WriteId, Job, Stats, BakeHash, bUseBakeCache, CleanupHandle]()
+		{
+			FWorldDelegates::OnWorldCleanup.Remove(CleanupHandle);
+			Cache->RemoveFromRoot();
 
-			// Sub-sample points inside cell (center of sub-cells)
-			for (int32 sy = 0; sy < SamplesPerAxis; ++sy)
+			// Guard: write cancelled meanwhile (world cleanup, load/undo of the cache): back buffer already released
+			if (!Cache->OwnsWrite(WriteId))
 			{
-				for (int32 sx = 0; sx < SamplesPerAxis; ++sx)
-				{
-					const float U = ((float)sx + 0.5f) / (float)SamplesPerAxis; // 0..1
-					const float V = ((float)sy + 0.5f) / (float)SamplesPerAxis;
+				UE_LOG(LogTemp, Warning, TEXT("Bake aborted: world cleaned up or HeightCache reloaded during bake"));
+				return;
+			}
 
-					const float SampleX = CellMinX + U * CellSizeCm;
-					const float SampleY = CellMinY + V * CellSizeCm;
+			// Guard: baker gone mid-bake: discard back buffer, keep previous snapshot
+			AVoxelGridBaker* Baker = WeakThis.Get();
+			if (!Baker || Stats.bAborted)
+			{
+				Cache->AbortWrite();
+				UE_LOG(LogTemp, Warning, TEXT("Bake aborted: baker destroyed during bake"));
+				return;
+			}
 
-					// Trace vertical line: above -> below landscape
-					const FVector Start(SampleX, SampleY, Landscape->GetActorLocation().Z + TraceStartCm);
-					const FVector End  (SampleX, SampleY, Landscape->GetActorLocation().Z - TraceEndCm);
+			// Horizon map stays valid away from changed cells: carry it over and update only around them
+			FVoxelCacheChannel KeptHorizon;
+			const bool bKeepHorizon = Baker->HeightCache == Cache && Stats.bSameLayout
+				&& Cache->Channels.RemoveAndCopyValue(FVoxelHorizonMap::HorizonChannel, KeptHorizon);
 
-					FHitResult Hit;
-					const bool bHit = GetWorld()->LineTraceSingleByChannel(
-						Hit,
-						Start,
-						End,
-						GridConfig->TraceChannel,
-						Params
-					);
+			// Swap finished bake in as current snapshot
+			Cache->Publish();
+			if (bKeepHorizon)
+			{
+				Cache->Channels.Add(FVoxelHorizonMap::HorizonChannel, MoveTemp(KeptHorizon));
+			}
+			if (Baker->HeightCache == Cache)
+			{
+				Baker->RefreshDerivedData(Stats.ChangedCells);
+			}
 
-					// Track highest hit inside this cell
-					if (bHit)
-					{
-						HitCount++;
-						MaxZ = FMath::Max(MaxZ, Hit.Location.Z);
-					}
+			// Remember bake inputs and store result for later reuse
+			Cache->BakeHash = BakeHash;
+			if (bUseBakeCache && !FVoxelBakeStore::Save(BakeHash, Cache))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Bake result could not be stored (Hash=%s)"), *BakeHash);
+			}
+
+			// Mark asset dirty in editor (save changes)
+#if WITH_EDITOR
+			Cache->Modify();
+#endif
+
+			const int32 TotalCells = Job.GridSize.X * Job.GridSize.Y;
+			if (Job.bAdaptive)
+			{
+				const int64 AdaptiveTraces = Stats.TraceCount - Stats.ReferenceTraces;
+				const int64 FixedTraces = (int64)TotalCells * Job.SamplesPerAxis * Job.SamplesPerAxis;
+
+				UE_LOG(LogTemp, Display, TEXT("Adaptive sampling: Traces=%lld vs fixed %lld (saved %lld, %.1f%%), MaxDepth=%d, Tolerance=%.2fm"),
+					AdaptiveTraces, FixedTraces, FixedTraces - AdaptiveTraces,
+					FixedTraces > 0 ? 100.0 * (double)(FixedTraces - AdaptiveTraces) / (double)FixedTraces : 0.0,
+					Job.MaxDepth, Job.ToleranceCm / 100.0f);
+
+				if (Job.bReportError)
+				{
+					const int32 LatticePoints = (1 << (Job.MaxDepth + 1)) + 1;
+					UE_LOG(LogTemp, Display, TEXT("Adaptive sampling: max error vs %dx%d lattice reference = %.1f cm (reference traces=%lld)"),
+						LatticePoints, LatticePoints, Stats.MaxErrorCm, Stats.ReferenceTraces);
 				}
 			}
 
-			// Store max height (world Z in cm) for this cell
-			const int32 Idx = HeightCache->ToIndex(X, Y);
-			HeightCache->MaxHeightCm[Idx] = MaxZ;
+			UE_LOG(LogTemp, Display, TEXT("Bake complete. Cells=%d, Changed=%dx%d cells, Sampling=%s, TotalTraces=%lld, Hits=%lld"),
+				TotalCells, Stats.ChangedCells.Width(), Stats.ChangedCells.Height(),
+				Job.bAdaptive ? TEXT("Adaptive") : *FString::Printf(TEXT("%dx%d"), Job.SamplesPerAxis, Job.SamplesPerAxis),
+				Stats.TraceCount - Stats.ReferenceTraces, Stats.HitCount - Stats.ReferenceHits);
+		});
+	}));
+}
+
+// Import DEM raster tiles straight into the height cache (no landscape round-trip)
+void AVoxelGridBaker::ImportDemTiles()
+{
+	// Guard: required refs
+	if (!GridConfig || !HeightCache)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ImportDemTiles failed: GridConfig or HeightCache missing"));
+		return;
+	}
+
+	// Guard: background bake owns the back buffer
+	if (HeightCache->IsWriteInProgress())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ImportDemTiles failed: a bake into this HeightCache is still running."));
+		return;
+	}
+
+	// Guard: tiles configured and readable
+	FBox2D DemBounds;
+	if (!FVoxelDemImporter::ComputeWorldBounds(GridConfig, DemBounds))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ImportDemTiles failed: no readable DemTiles in GridConfig"));
+		return;
+	}
+
+	// Grid covers DEM extent (same rules as BuildGrid); baker grid only replaced once the import succeeded
+	FVector DemGridMin, DemGridMax;
+	FIntPoint DemGridSize;
+	float DemCellSizeCm;
+	if (!ComputeGridFromBounds(FVector(DemBounds.Min, 0.0), FVector(DemBounds.Max, 0.0), DemGridMin, DemGridMax, DemGridSize, DemCellSizeCm))
+		return;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Reduce into back buffer; queries keep reading the previous snapshot
+	FVoxelHeightSnapshot* Back = HeightCache->BeginWrite();
+	if (!Back)
+		return;
+
+	Back->Reset(DemGridMin, DemGridSize, DemCellSizeCm);
+
+	int64 PixelCount = 0;
+	if (!FVoxelDemImporter::ImportTiles(GridConfig, *Back, PixelCount))
+	{
+		HeightCache->AbortWrite();
+		UE_LOG(LogTemp, Warning, TEXT("ImportDemTiles failed: no tile could be imported"));
+		return;
+	}
+
+	HeightCache->Publish();
+
+	// Baker grid follows the published DEM grid
+	GridMinWorld = DemGridMin;
+	GridMaxWorld = DemGridMax;
+	GridSize = DemGridSize;
+	CellSizeCm = DemCellSizeCm;
+
+	UE_LOG(LogTemp, Display, TEXT("Grid Built: Size=%d x %d (Cells=%d), CellSize=%.2fm"),
+		GridSize.X, GridSize.Y, GridSize.X * GridSize.Y, CellSizeCm / 100.0f);
+
+	RefreshDerivedData(FIntRect(FIntPoint(0, 0), HeightCache->GridSize));
+
+	// Not a trace bake result
+	HeightCache->BakeHash.Reset();
+
+#if WITH_EDITOR
+	HeightCache->Modify();
+#endif
+
+	UE_LOG(LogTemp, Display, TEXT("DEM import complete. Tiles=%d, Pixels=%lld, Cells=%d, Time=%.2f s"),
+		GridConfig->DemTiles.Num(), PixelCount, GridSize.X * GridSize.Y, FPlatformTime::Seconds() - StartTime);
+}
+
+// Flood analysis for configured water level, stored as WaterDepth/FloodRegion channels
+void AVoxelGridBaker::RunFloodAnalysis()
+{
+	// Guard: baked cache required
+	if (!HeightCache || !HeightCache->IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RunFloodAnalysis failed: HeightCache invalid. Bake first."));
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FVoxelFloodSettings Settings;
+	Settings.WaterLevelWorldZCm = HeightCache->SeaLevelWorldZCm + FloodWaterLevelMetersASL * 100.0f;
+	Settings.bSeedFromBorder = bFloodFromBorder;
+
+	FVoxelFloodResult Result;
+	{
+		FVoxelHeightReadScope Scope(*HeightCache);
+		const FVoxelHeightSnapshot& Snap = Scope.Get();
+
+		// Seed actors -> cells
+		for (const AActor* Seed : FloodSeedActors)
+		{
+			if (!Seed) continue;
+			const FVector P = Seed->GetActorLocation();
+			Settings.SeedCells.Add(FIntPoint(
+				FMath::FloorToInt((P.X - Snap.GridMinWorld.X) / Snap.CellSizeCm),
+				FMath::FloorToInt((P.Y - Snap.GridMinWorld.Y) / Snap.CellSizeCm)));
+		}
+
+		if (!FVoxelFloodAnalysis::Run(Snap, Settings, Result))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RunFloodAnalysis failed: snapshot invalid"));
+			return;
 		}
 	}
 
-	// Mark asset dirty in editor (save changes)
+	// Store results as cache channels
+	TArray<float> RegionValues;
+	RegionValues.SetNumUninitialized(Result.RegionId.Num());
+	for (int32 i = 0; i < Result.RegionId.Num(); ++i)
+	{
+		RegionValues[i] = (float)Result.RegionId[i];
+	}
+	HeightCache->SetChannel(FVoxelFloodAnalysis::WaterDepthChannel, MoveTemp(Result.WaterDepthCm));
+	HeightCache->SetChannel(FVoxelFloodAnalysis::FloodRegionChannel, MoveTemp(RegionValues));
+
 #if WITH_EDITOR
 	HeightCache->Modify();
 #endif
 
-	UE_LOG(LogTemp, Display, TEXT("Bake complete. Cells=%d, SamplesPerCell=%d, TotalTraces=%d, Hits=%d"),
-		TotalCells, SamplesTotal, TotalCells * SamplesTotal, HitCount);
+	UE_LOG(LogTemp, Display, TEXT("Flood @ %.2fm ASL: Regions=%d, FloodedCells=%lld / %d, Time=%.1f ms"),
+		FloodWaterLevelMetersASL, Result.NumRegions, Result.FloodedCells,
+		HeightCache->GridSize.X * HeightCache->GridSize.Y, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+// Viewshed from preview center and debug draw of visible cells
+void AVoxelGridBaker::DebugDrawViewshed()
+{
+	// Guard: baked cache required
+	if (!GetWorld() || !HeightCache || !HeightCache->IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DebugDrawViewshed failed: HeightCache invalid. Bake first."));
+		return;
+	}
+
+	FVoxelViewshedSettings Settings;
+	Settings.ObserverWorld = PreviewCenterActor
+		? PreviewCenterActor->GetActorLocation()
+		: HeightCache->GridMinWorld + FVector(HeightCache->GridSize.X, HeightCache->GridSize.Y, 0.0) * HeightCache->CellSizeCm * 0.5;
+	Settings.ObserverHeightCm = ViewshedObserverHeightMeters * 100.0f;
+	Settings.MaxRadiusCells = ViewshedRadiusCells;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FVoxelViewshedResult Result;
+	if (!HeightCache->ComputeViewshed(Settings, Result))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DebugDrawViewshed failed: observer outside grid or on invalid cell"));
+		return;
+	}
+
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	const float Lifetime = GridConfig ? GridConfig->DebugDrawLifetime : 10.0f;
+	const float Cell = HeightCache->CellSizeCm;
+
+	// Visible cells as points on top of the cell max height
+	for (int32 DY = -Result.Radius; DY <= Result.Radius; ++DY)
+	{
+		for (int32 DX = -Result.Radius; DX <= Result.Radius; ++DX)
+		{
+			const int32 X = Result.ObserverCell.X + DX;
+			const int32 Y = Result.ObserverCell.Y + DY;
+			if (!Result.IsVisible(X, Y))
+				continue;
+
+			const FVector P(
+				HeightCache->GridMinWorld.X + (X + 0.5f) * Cell,
+				HeightCache->GridMinWorld.Y + (Y + 0.5f) * Cell,
+				HeightCache->GetMaxHeightCm(X, Y) + 50.0f);
+			DrawDebugPoint(GetWorld(), P, 8.0f, FColor::Green, false, Lifetime);
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Viewshed: Cell(%d,%d), Radius=%d, Visible=%d cells, Time=%.2f ms"),
+		Result.ObserverCell.X, Result.ObserverCell.Y, Result.Radius, Result.NumVisible, ElapsedMs);
+}
+
+// Draw cells in terrain shadow for the configured sun direction
+void AVoxelGridBaker::DebugDrawTerrainShadow()
+{
+	// Guard: baked horizon map required
+	if (!GetWorld() || !HeightCache || !HeightCache->IsValid() || !HeightCache->FindChannel(FVoxelHorizonMap::HorizonChannel))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DebugDrawTerrainShadow failed: no horizon map. Enable bBakeHorizonMap and bake first."));
+		return;
+	}
+
+	const FVector SunDir = FRotator(SunElevationDegrees, SunAzimuthDegrees, 0.0f).Vector();
+
+	const FVector Min = HeightCache->GridMinWorld;
+	const float Cell = HeightCache->CellSizeCm;
+	const FVector Center = PreviewCenterActor
+		? PreviewCenterActor->GetActorLocation()
+		: Min + FVector(HeightCache->GridSize.X * Cell * 0.5f, HeightCache->GridSize.Y * Cell * 0.5f, 0.0f);
+	const int32 CX = FMath::FloorToInt((Center.X - Min.X) / Cell);
+	const int32 CY = FMath::FloorToInt((Center.Y - Min.Y) / Cell);
+	const int32 R = ShadowDrawRadiusCells;
+
+	const double StartTime = FPlatformTime::Seconds();
+	const float Lifetime = GridConfig ? GridConfig->DebugDrawLifetime : 10.0f;
+
+	int32 Shadowed = 0;
+	int32 Tested = 0;
+	for (int32 Y = FMath::Max(0, CY - R); Y <= FMath::Min(HeightCache->GridSize.Y - 1, CY + R); ++Y)
+	{
+		for (int32 X = FMath::Max(0, CX - R); X <= FMath::Min(HeightCache->GridSize.X - 1, CX + R); ++X)
+		{
+			const float Z = HeightCache->GetMaxHeightCm(X, Y);
+			if (Z <= -1e20f)
+				continue;
+
+			const FVector P(Min.X + (X + 0.5f) * Cell, Min.Y + (Y + 0.5f) * Cell, Z);
+			Tested++;
+			if (HeightCache->IsInTerrainShadow(P, SunDir))
+			{
+				Shadowed++;
+				DrawDebugPoint(GetWorld(), P + FVector(0, 0, 50.0f), 8.0f, FColor::Blue, false, Lifetime);
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Terrain shadow: Sun(Az=%.1f, El=%.1f), Shadowed=%d / %d cells, Time=%.2f ms"),
+		SunAzimuthDegrees, SunElevationDegrees, Shadowed, Tested, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+// Build hierarchical path graph from current heights
+void AVoxelGridBaker::BuildPathGraph()
+{
+	// Guard: baked cache required
+	if (!HeightCache || !HeightCache->IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("BuildPathGraph failed: HeightCache invalid. Bake first."));
+		return;
+	}
+
+	FVoxelPathSettings Settings;
+	Settings.ClusterSize = PathClusterSize;
+	Settings.MaxSlopeDegrees = PathMaxSlopeDegrees;
+	Settings.SlopeCostFactor = PathSlopeCostFactor;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	if (!Pathfinder)
+	{
+		Pathfinder = MakeShared<FVoxelPathfinder, ESPMode::ThreadSafe>();
+	}
+	{
+		FVoxelHeightReadScope Scope(*HeightCache);
+		Pathfinder->Build(Scope.Get(), Settings);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Path graph built: Nodes=%d, ClusterSize=%d, Time=%.1f ms"),
+		Pathfinder->GetNumNodes(), PathClusterSize, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+// Re-sync derived channels, path graph and contours with newly published heights
+void AVoxelGridBaker::RefreshDerivedData(const FIntRect& DirtyCells)
+{
+	if (!HeightCache)
+		return;
+
+	RefreshDerivedChannels(DirtyCells);
+
+	FVoxelHeightReadScope Scope(*HeightCache);
+	const FVoxelHeightSnapshot& Snap = Scope.Get();
+
+	if (Pathfinder)
+	{
+		Pathfinder->UpdateRegion(Snap, DirtyCells);
+	}
+	if (ContourExtractor.IsExtracted())
+	{
+		ContourExtractor.MarkDirty(DirtyCells);
+		ContourExtractor.Update(Snap, Contours);
+	}
+}
+
+// Bring enabled cache channels in line with current heights + config (disabled ones are dropped)
+void AVoxelGridBaker::RefreshDerivedChannels(const FIntRect& DirtyCells)
+{
+	if (!HeightCache)
+		return;
+
+	FVoxelHeightReadScope Scope(*HeightCache);
+	const FVoxelHeightSnapshot& Snap = Scope.Get();
+
+	// Empty rect: heights unchanged, only channels computed with other settings are stale
+	const bool bHeightsChanged = DirtyCells.Width() > 0 && DirtyCells.Height() > 0;
+
+	// Optional distance-to-feature channel
+	if (GridConfig && GridConfig->bBakeDistanceField)
+	{
+		FVoxelDistanceFieldSettings Settings;
+		Settings.Feature = GridConfig->DistanceFeature;
+		Settings.HeightThresholdWorldZCm = HeightCache->SeaLevelWorldZCm + GridConfig->DistanceHeightThresholdMeters * 100.0f;
+		Settings.SlopeDegrees = GridConfig->DistanceSlopeDegrees;
+
+		const FString Stamp = FString::Printf(TEXT("Feature=%d Threshold=%.3f Slope=%.3f"),
+			(int32)Settings.Feature, Settings.HeightThresholdWorldZCm, Settings.SlopeDegrees);
+
+		const FVoxelCacheChannel* Existing = HeightCache->FindChannel(FVoxelDistanceField::DistanceChannel);
+		if (bHeightsChanged || !Existing || Existing->Settings != Stamp)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+
+			TArray<float> Distance;
+			int64 FeatureCells = 0;
+			if (FVoxelDistanceField::Compute(Snap, Settings, Distance, FeatureCells))
+			{
+				HeightCache->SetChannel(FVoxelDistanceField::DistanceChannel, MoveTemp(Distance), 1, Stamp);
+				UE_LOG(LogTemp, Display, TEXT("Distance field baked: FeatureCells=%lld, Time=%.1f ms"),
+					FeatureCells, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			}
+		}
+	}
+	else
+	{
+		HeightCache->Channels.Remove(FVoxelDistanceField::DistanceChannel);
+	}
+
+	// Optional horizon map: same settings -> recompute only cells that can see the dirty area, else full recompute
+	if (GridConfig && GridConfig->bBakeHorizonMap)
+	{
+		FVoxelHorizonSettings Settings;
+		Settings.NumAzimuths = FMath::Clamp(GridConfig->HorizonAzimuths, 4, 64);
+		Settings.MaxDistanceCells = FMath::Max(1, GridConfig->HorizonMaxDistanceCells);
+
+		const FString Stamp = FString::Printf(TEXT("Azimuths=%d MaxDistance=%d"), Settings.NumAzimuths, Settings.MaxDistanceCells);
+
+		FVoxelCacheChannel* Existing = HeightCache->Channels.Find(FVoxelHorizonMap::HorizonChannel);
+		const bool bSameSettings = Existing && Existing->NumComponents == Settings.NumAzimuths && Existing->Settings == Stamp;
+
+		if (!bSameSettings || bHeightsChanged)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+
+			bool bUpdated = false;
+			if (bSameSettings)
+			{
+				bUpdated = FVoxelHorizonMap::UpdateRegion(Snap, Settings, DirtyCells, Existing->Values);
+			}
+			if (!bUpdated)
+			{
+				TArray<float> Angles;
+				if (FVoxelHorizonMap::Compute(Snap, Settings, Angles))
+				{
+					HeightCache->SetChannel(FVoxelHorizonMap::HorizonChannel, MoveTemp(Angles), Settings.NumAzimuths, Stamp);
+				}
+			}
+
+			UE_LOG(LogTemp, Display, TEXT("Horizon map %s: Azimuths=%d, MaxDistance=%d cells, Time=%.1f ms"),
+				bUpdated ? TEXT("updated") : TEXT("baked"), Settings.NumAzimuths, Settings.MaxDistanceCells,
+				(FPlatformTime::Seconds() - StartTime) * 1000.0);
+		}
+	}
+	else
+	{
+		HeightCache->Channels.Remove(FVoxelHorizonMap::HorizonChannel);
+	}
+}
+
+// Query path between PreviewCenterActor and PathGoalActor and draw it
+void AVoxelGridBaker::DebugFindPath()
+{
+	// Guard: graph + endpoints
+	if (!GetWorld() || !HeightCache || !Pathfinder || !Pathfinder->IsBuilt() || !PreviewCenterActor || !PathGoalActor)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DebugFindPath failed: build path graph and set PreviewCenterActor + PathGoalActor first"));
+		return;
+	}
+
+	const FVector Min = HeightCache->GridMinWorld;
+	const float Cell = HeightCache->CellSizeCm;
+	auto ToCell = [&](const FVector& P)
+	{
+		return FIntPoint(FMath::FloorToInt((P.X - Min.X) / Cell), FMath::FloorToInt((P.Y - Min.Y) / Cell));
+	};
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FVoxelPathResult Result;
+	const bool bFound = Pathfinder->FindPath(ToCell(PreviewCenterActor->GetActorLocation()), ToCell(PathGoalActor->GetActorLocation()), Result);
+
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	if (!bFound)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DebugFindPath: no path (Expanded=%d, Time=%.2f ms)"), Result.ExpandedNodes, ElapsedMs);
+		return;
+	}
+
+	// Draw path slightly above cell max heights
+	const float Lifetime = GridConfig ? GridConfig->DebugDrawLifetime : 10.0f;
+	auto CellPoint = [&](const FIntPoint& C)
+	{
+		return FVector(Min.X + (C.X + 0.5f) * Cell, Min.Y + (C.Y + 0.5f) * Cell, HeightCache->GetMaxHeightCm(C.X, C.Y) + 100.0f);
+	};
+	for (int32 i = 1; i < Result.Cells.Num(); ++i)
+	{
+		DrawDebugLine(GetWorld(), CellPoint(Result.Cells[i - 1]), CellPoint(Result.Cells[i]), FColor::Orange, false, Lifetime, 0, 20.0f);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Path found: Cells=%d, Cost=%.1f m, Expanded=%d, Time=%.2f ms"),
+		Result.Cells.Num(), Result.Cost / 100.0f, Result.ExpandedNodes, ElapsedMs);
+}
+
+// Extract contour lines at ContourIntervalMeters above sea level and draw them
+void AVoxelGridBaker::DebugDrawContours()
+{
+	// Guard: baked cache required
+	if (!GetWorld() || !HeightCache || !HeightCache->IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DebugDrawContours failed: HeightCache invalid. Bake first."));
+		return;
+	}
+
+	FVoxelContourSettings Settings;
+	Settings.IntervalCm = ContourIntervalMeters * 100.0f;
+	Settings.BaseLevelCm = HeightCache->SeaLevelWorldZCm;
+	Settings.bIncludeBelowBase = bContoursBelowSeaLevel;
+
+	const double StartTime = FPlatformTime::Seconds();
+	{
+		FVoxelHeightReadScope Scope(*HeightCache);
+		ContourExtractor.Extract(Scope.Get(), Settings, Contours);
+	}
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	// Draw polylines slightly above their level
+	const float Lifetime = GridConfig ? GridConfig->DebugDrawLifetime : 10.0f;
+	for (int32 i = 0; i < Contours.NumPolylines(); ++i)
+	{
+		const TConstArrayView<FVector2f> Line = Contours.GetPolyline(i);
+		const float Z = Contours.PolylineLevels[i] + 50.0f;
+		for (int32 p = 1; p < Line.Num(); ++p)
+		{
+			DrawDebugLine(GetWorld(), FVector(Line[p - 1].X, Line[p - 1].Y, Z), FVector(Line[p].X, Line[p].Y, Z), FColor::Yellow, false, Lifetime);
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Contours: Interval=%.1f m, Polylines=%d, Points=%d, Time=%.1f ms"),
+		ContourIntervalMeters, Contours.NumPolylines(), Contours.Points.Num(), ElapsedMs);
+}
+
+// Generate coarser cache from the fine bake (max-reduction instead of new traces)
+void AVoxelGridBaker::DeriveCoarserCache()
+{
+	// Guard: source + target caches
+	if (!HeightCache || !DerivedHeightCache)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DeriveCoarserCache failed: HeightCache or DerivedHeightCache missing"));
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	if (!DerivedHeightCache->DeriveCoarserFrom(HeightCache, DerivedCellSizeMeters * 100.0f))
+		return;
+
+	UE_LOG(LogTemp, Display, TEXT("Derived cache built: %.2fm -> %.2fm, Size=%d x %d, Time=%.1f ms"),
+		HeightCache->CellSizeCm / 100.0f, DerivedCellSizeMeters,
+		DerivedHeightCache->GridSize.X, DerivedHeightCache->GridSize.Y,
+		(FPlatformTime::Seconds() - StartTime) * 1000.0);
 }
 
 // Choose preview base Z (sea level or manual override)
@@ -356,13 +1214,9 @@ void AVoxelGridBaker::BuildPreviewVoxels()
 	{
 		for (int32 X = MinX; X <= MaxX; ++X)
 		{
-			const int32 Idx = HeightCache->ToIndex(X, Y);
-			if (!HeightCache->MaxHeightCm.IsValidIndex(Idx))
-				continue;
-
-			const float MaxZcm = HeightCache->MaxHeightCm[Idx];
+			const float MaxZcm = HeightCache->GetMaxHeightCm(X, Y);
 
-			// Skip uninitialized cells
+			// Skip uninitialized or out-of-grid cells
 			if (MaxZcm <= -1e20f)
 				continue;
 
@@ -1,4 +1,441 @@
 // Runtime data container for baked voxel height results
 // Stores per-cell max height and grid metadata
 
-#include "VoxelHeightCache.h"
\ No newline at end of file
+#include "VoxelHeightCache.h"
+
+#include "VoxelViewshed.h"
+#include "VoxelHorizonMap.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformProcess.h"
+
+// Register reader on the current front buffer
+int32 UVoxelHeightCache::AcquireRead() const
+{
+	for (;;)
+	{
+		const int32 Index = FrontIndex.load();
+		ReaderCounts[Index].fetch_add(1);
+
+		// Still front after registering: writer cannot reuse this buffer until released
+		if (FrontIndex.load() == Index)
+			return Index;
+
+		// Publish happened in between: back off and retry on new front
+		ReaderCounts[Index].fetch_sub(1);
+	}
+}
+
+// Release reader registered by AcquireRead
+void UVoxelHeightCache::ReleaseRead(int32 Index) const
+{
+	ReaderCounts[Index].fetch_sub(1);
+}
+
+// Claim back buffer once all readers of the previous snapshot are gone
+FVoxelHeightSnapshot* UVoxelHeightCache::BeginWrite()
+{
+	// Guard: single writer (a background bake may hold the back buffer for a long time)
+	bool bExpected = false;
+	if (!bWriteInProgress.compare_exchange_strong(bExpected, true))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: write refused, another write (bake) is in progress"), *GetName());
+		return nullptr;
+	}
+
+	WriteId++;
+	bWriteCancelled.store(false);
+
+	const int32 Back = 1 - FrontIndex.load();
+
+	// Readers never wait; only the writer spins until stale readers drain
+	while (ReaderCounts[Back].load() != 0)
+	{
+		FPlatformProcess::YieldThread();
+	}
+	return &Buffers[Back];
+}
+
+// Release back buffer without publishing
+void UVoxelHeightCache::AbortWrite()
+{
+	WriteTask.Reset();
+	bWriteInProgress.store(false);
+}
+
+// Remember worker of the current write
+void UVoxelHeightCache::SetWriteTask(TFuture<void>&& Task)
+{
+	WriteTask = MoveTemp(Task);
+}
+
+// Stop the current writer and wait until it no longer touches the back buffer
+void UVoxelHeightCache::CancelWrite()
+{
+	if (!bWriteInProgress.load())
+		return;
+
+	bWriteCancelled.store(true);
+	if (WriteTask.IsValid())
+	{
+		WriteTask.Wait();
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("%s: write in progress cancelled"), *GetName());
+	AbortWrite();
+}
+
+// Swap back buffer to front
+void UVoxelHeightCache::SwapBuffers()
+{
+	FrontIndex.store(1 - FrontIndex.load());
+}
+
+// Publish back buffer and mirror its grid metadata into properties (heights are not copied)
+void UVoxelHeightCache::Publish()
+{
+	SwapBuffers();
+
+	const FVoxelHeightSnapshot& Front = Buffers[FrontIndex.load()];
+	GridMinWorld = Front.GridMinWorld;
+	GridSize = Front.GridSize;
+	CellSizeCm = Front.CellSizeCm;
+
+	// Channels were derived from the previous heights: stale even on an unchanged layout
+	Channels.Empty();
+
+	AbortWrite();
+}
+
+// Store channel values for current grid
+bool UVoxelHeightCache::SetChannel(FName Name, TArray<float>&& Values, int32 NumComponents, const FString& Settings)
+{
+	FVoxelHeightReadScope Scope(*this);
+	const FIntPoint Size = Scope.Get().GridSize;
+
+	// Guard: channel must match grid
+	if (NumComponents <= 0 || Values.Num() != Size.X * Size.Y * NumComponents)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SetChannel %s failed: size mismatch"), *Name.ToString());
+		return false;
+	}
+
+	FVoxelCacheChannel& Channel = Channels.FindOrAdd(Name);
+	Channel.NumComponents = NumComponents;
+	Channel.Values = MoveTemp(Values);
+	Channel.Settings = Settings;
+	return true;
+}
+
+// Find channel by name
+const FVoxelCacheChannel* UVoxelHeightCache::FindChannel(FName Name) const
+{
+	return Channels.Find(Name);
+}
+
+// Read single channel value
+float UVoxelHeightCache::GetChannelValue(FName Name, int32 X, int32 Y, int32 Component, float Fallback) const
+{
+	const FVoxelCacheChannel* Channel = Channels.Find(Name);
+	if (!Channel || Component < 0 || Component >= Channel->NumComponents)
+		return Fallback;
+
+	FVoxelHeightReadScope Scope(*this);
+	const FVoxelHeightSnapshot& Snap = Scope.Get();
+	if (!Snap.IsValidCell(X, Y))
+		return Fallback;
+
+	const int32 Idx = Snap.ToIndex(X, Y) * Channel->NumComponents + Component;
+	return Channel->Values.IsValidIndex(Idx) ? Channel->Values[Idx] : Fallback;
+}
+
+// Read channel value at world XY
+float UVoxelHeightCache::GetChannelValueAtWorld(FName Name, const FVector& WorldPos, int32 Component, float Fallback) const
+{
+	int32 X, Y;
+	if (!WorldToCell(WorldPos, X, Y))
+		return Fallback;
+
+	return GetChannelValue(Name, X, Y, Component, Fallback);
+}
+
+// Horizon channel values of the cell containing world XY (nullptr if missing)
+static const float* FindHorizonCell(const UVoxelHeightCache& Cache, const FVector& WorldPos, int32& OutNumAzimuths)
+{
+	const FVoxelCacheChannel* Channel = Cache.FindChannel(FVoxelHorizonMap::HorizonChannel);
+	int32 X, Y;
+	if (!Channel || !Cache.WorldToCell(WorldPos, X, Y))
+		return nullptr;
+
+	const int32 Idx = Cache.ToIndex(X, Y) * Channel->NumComponents;
+	if (Idx + Channel->NumComponents > Channel->Values.Num())
+		return nullptr;
+
+	OutNumAzimuths = Channel->NumComponents;
+	return Channel->Values.GetData() + Idx;
+}
+
+// Sun below interpolated horizon -> shadowed
+bool UVoxelHeightCache::IsInTerrainShadow(const FVector& WorldPos, const FVector& SunDirection) const
+{
+	int32 NumAzimuths = 0;
+	const float* Angles = FindHorizonCell(*this, WorldPos, NumAzimuths);
+	if (!Angles)
+		return false;
+
+	const float Azimuth = FMath::Atan2(SunDirection.Y, SunDirection.X);
+	const float Elevation = FMath::Atan2(SunDirection.Z, FVector2D(SunDirection.X, SunDirection.Y).Size());
+	return Elevation < FVoxelHorizonMap::SampleHorizon(Angles, NumAzimuths, Azimuth);
+}
+
+// Sky view factor from horizon angles
+float UVoxelHeightCache::GetSkyVisibility(const FVector& WorldPos) const
+{
+	int32 NumAzimuths = 0;
+	const float* Angles = FindHorizonCell(*this, WorldPos, NumAzimuths);
+	return Angles ? FVoxelHorizonMap::SkyVisibility(Angles, NumAzimuths) : 1.0f;
+}
+
+// Publish empty grid with current metadata
+void UVoxelHeightCache::Allocate(int32 SizeX, int32 SizeY)
+{
+	FVoxelHeightSnapshot* Back = BeginWrite();
+	if (!Back)
+		return;
+
+	Back->Reset(GridMinWorld, FIntPoint(SizeX, SizeY), CellSizeCm);
+	Publish();
+}
+
+// Thread-safe height lookup at world XY
+bool UVoxelHeightCache::GetMaxHeightAtWorld(const FVector& WorldPos, float& OutHeightCm) const
+{
+	FVoxelHeightReadScope Scope(*this);
+	const FVoxelHeightSnapshot& Snap = Scope.Get();
+
+	// Guard: nothing baked yet
+	if (!Snap.IsValid())
+		return false;
+
+	const int32 X = FMath::FloorToInt((WorldPos.X - Snap.GridMinWorld.X) / Snap.CellSizeCm);
+	const int32 Y = FMath::FloorToInt((WorldPos.Y - Snap.GridMinWorld.Y) / Snap.CellSizeCm);
+	if (!Snap.IsValidCell(X, Y))
+		return false;
+
+	OutHeightCm = Snap.MaxHeightCm[Snap.ToIndex(X, Y)];
+	return OutHeightCm > -1e20f;
+}
+
+// Thread-safe cell height lookup
+float UVoxelHeightCache::GetMaxHeightCm(int32 X, int32 Y) const
+{
+	FVoxelHeightReadScope Scope(*this);
+	const FVoxelHeightSnapshot& Snap = Scope.Get();
+	return Snap.IsValid() && Snap.IsValidCell(X, Y) ? Snap.MaxHeightCm[Snap.ToIndex(X, Y)] : -FLT_MAX;
+}
+
+// Thread-safe world XY -> cell
+bool UVoxelHeightCache::WorldToCell(const FVector& WorldPos, int32& OutX, int32& OutY) const
+{
+	FVoxelHeightReadScope Scope(*this);
+	const FVoxelHeightSnapshot& Snap = Scope.Get();
+	if (Snap.CellSizeCm <= 0.0f)
+		return false;
+
+	OutX = FMath::FloorToInt((WorldPos.X - Snap.GridMinWorld.X) / Snap.CellSizeCm);
+	OutY = FMath::FloorToInt((WorldPos.Y - Snap.GridMinWorld.Y) / Snap.CellSizeCm);
+	return Snap.IsValidCell(OutX, OutY);
+}
+
+bool UVoxelHeightCache::IsValid() const
+{
+	FVoxelHeightReadScope Scope(*this);
+	return Scope.Get().IsValid();
+}
+
+int32 UVoxelHeightCache::ToIndex(int32 X, int32 Y) const
+{
+	FVoxelHeightReadScope Scope(*this);
+	return Scope.Get().ToIndex(X, Y);
+}
+
+// Height above sea level from current snapshot
+float UVoxelHeightCache::GetHeightMetersASL(int32 X, int32 Y) const
+{
+	const float Z = GetMaxHeightCm(X, Y);
+	return Z > -1e20f ? (Z - SeaLevelWorldZCm) / 100.0f : 0.0f;
+}
+
+// Thread-safe viewshed on current snapshot
+bool UVoxelHeightCache::ComputeViewshed(const FVoxelViewshedSettings& Settings, FVoxelViewshedResult& OutResult) const
+{
+	FVoxelHeightReadScope Scope(*this);
+	return FVoxelViewshed::Compute(Scope.Get(), Settings, OutResult);
+}
+
+// Move serialized heights into the front snapshot
+void UVoxelHeightCache::SyncSnapshotFromProperties()
+{
+	// Loaded state wins over a running bake (also undo/redo): stop it before reusing its buffer
+	CancelWrite();
+
+	FVoxelHeightSnapshot* Back = BeginWrite();
+	if (!Back)
+		return;
+
+	Back->GridMinWorld = GridMinWorld;
+	Back->GridSize = GridSize;
+	Back->CellSizeCm = CellSizeCm;
+	Back->MaxHeightCm = MoveTemp(MaxHeightCm);
+	MaxHeightCm.Empty();
+	SwapBuffers();
+	AbortWrite();
+}
+
+// Serialized height array exists only for the duration of a save/load (also undo transactions)
+void UVoxelHeightCache::Serialize(FArchive& Ar)
+{
+	const bool bPersistent = (Ar.IsSaving() || Ar.IsLoading()) && !Ar.IsObjectReferenceCollector() && !Ar.IsCountingMemory();
+
+	if (bPersistent && Ar.IsSaving())
+	{
+		FVoxelHeightReadScope Scope(*this);
+		MaxHeightCm = Scope.Get().MaxHeightCm;
+	}
+
+	Super::Serialize(Ar);
+
+	if (bPersistent)
+	{
+		if (Ar.IsLoading())
+		{
+			SyncSnapshotFromProperties();
+		}
+		else
+		{
+			MaxHeightCm.Empty();
+		}
+	}
+}
+
+// Derive coarser grid from finer cache: separable max over all overlapped source cells
+bool UVoxelHeightCache::DeriveCoarserFrom(const UVoxelHeightCache* Source, float NewCellSizeCm)
+{
+	// Guard: source cache
+	if (!Source)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DeriveCoarserFrom failed: source cache missing."));
+		return false;
+	}
+
+	// Consistent source snapshot for the whole reduction (source may be this cache)
+	FVoxelHeightReadScope SourceScope(*Source);
+	const FVoxelHeightSnapshot& SrcSnap = SourceScope.Get();
+
+	// Guard: valid baked source
+	if (!SrcSnap.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DeriveCoarserFrom failed: source cache invalid. Bake first."));
+		return false;
+	}
+
+	// Guard: only coarser (or equal) cell sizes can be derived
+	const float SrcCellCm = SrcSnap.CellSizeCm;
+	if (NewCellSizeCm < SrcCellCm)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("DeriveCoarserFrom failed: new cell size %.2fm is finer than source %.2fm"),
+			NewCellSizeCm / 100.0f, SrcCellCm / 100.0f);
+		return false;
+	}
+
+	const FIntPoint SrcSize = SrcSnap.GridSize;
+	const float Ratio = NewCellSizeCm / SrcCellCm;
+
+	// Coarse grid covers full source extent (same origin)
+	const FIntPoint DstSize(
+		FMath::Max(1, FMath::CeilToInt((float)SrcSize.X / Ratio - 1e-4f)),
+		FMath::Max(1, FMath::CeilToInt((float)SrcSize.Y / Ratio - 1e-4f)));
+
+	// Source cell range [First, Last] overlapped by each coarse cell (partial overlap counts)
+	auto BuildRanges = [Ratio](int32 DstNum, int32 SrcNum, TArray<FIntPoint>& OutRanges)
+	{
+		OutRanges.SetNumUninitialized(DstNum);
+		for (int32 i = 0; i < DstNum; ++i)
+		{
+			const int32 First = FMath::Clamp(FMath::FloorToInt((float)i * Ratio + 1e-4f), 0, SrcNum - 1);
+			const int32 Last  = FMath::Clamp(FMath::CeilToInt((float)(i + 1) * Ratio - 1e-4f) - 1, First, SrcNum - 1);
+			OutRanges[i] = FIntPoint(First, Last);
+		}
+
+		// Last coarse cell absorbs any remaining source cells
+		OutRanges.Last().Y = SrcNum - 1;
+	};
+
+	TArray<FIntPoint> RangesX, RangesY;
+	BuildRanges(DstSize.X, SrcSize.X, RangesX);
+	BuildRanges(DstSize.Y, SrcSize.Y, RangesY);
+
+	// Reduce straight into back buffer; readers keep seeing previous snapshot
+	// Guard: target busy (e.g. background bake into this cache)
+	FVoxelHeightSnapshot* Back = BeginWrite();
+	if (!Back)
+		return false;
+
+	Back->GridMinWorld = SrcSnap.GridMinWorld;
+	Back->GridSize = DstSize;
+	Back->CellSizeCm = NewCellSizeCm;
+	Back->MaxHeightCm.SetNumUninitialized(DstSize.X * DstSize.Y);
+
+	const float* Src = SrcSnap.MaxHeightCm.GetData();
+	float* Dst = Back->MaxHeightCm.GetData();
+
+	// One coarse row per task: vertical max of source rows (SIMD), then horizontal range max
+	ParallelFor(DstSize.Y, [&](int32 Y)
+	{
+		TArray<float> ColumnMax;
+		ColumnMax.SetNumUninitialized(SrcSize.X);
+		float* Col = ColumnMax.GetData();
+
+		const FIntPoint RowRange = RangesY[Y];
+		FMemory::Memcpy(Col, Src + (int64)RowRange.X * SrcSize.X, SrcSize.X * sizeof(float));
+
+		const int32 VecEnd = SrcSize.X & ~3;
+		for (int32 SrcY = RowRange.X + 1; SrcY <= RowRange.Y; ++SrcY)
+		{
+			const float* Row = Src + (int64)SrcY * SrcSize.X;
+
+			int32 X = 0;
+			for (; X < VecEnd; X += 4)
+			{
+				VectorStore(VectorMax(VectorLoad(Col + X), VectorLoad(Row + X)), Col + X);
+			}
+			for (; X < SrcSize.X; ++X)
+			{
+				Col[X] = FMath::Max(Col[X], Row[X]);
+			}
+		}
+
+		float* OutRow = Dst + (int64)Y * DstSize.X;
+		for (int32 X = 0; X < DstSize.X; ++X)
+		{
+			const FIntPoint Range = RangesX[X];
+			float MaxZ = Col[Range.X];
+			for (int32 SrcX = Range.X + 1; SrcX <= Range.Y; ++SrcX)
+			{
+				MaxZ = FMath::Max(MaxZ, Col[SrcX]);
+			}
+			OutRow[X] = MaxZ;
+		}
+	});
+
+	// Publish new grid
+	SeaLevelWorldZCm = Source->SeaLevelWorldZCm;
+	Publish();
+
+	// Not a trace bake result: never matches a baker hash
+	BakeHash.Reset();
+
+#if WITH_EDITOR
+	Modify();
+#endif
+	return true;
+}
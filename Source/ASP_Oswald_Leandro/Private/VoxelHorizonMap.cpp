@@ -0,0 +1,130 @@
+// Horizon-angle maps on the baked height grid
+// Per-cell horizon elevation for N azimuths; sun-shadow and sky-visibility lookups by interpolation
+
+#include "VoxelHorizonMap.h"
+
+#include "VoxelHeightCache.h"
+#include "Async/ParallelFor.h"
+
+const FName FVoxelHorizonMap::HorizonChannel(TEXT("HorizonAngle"));
+
+namespace VoxelHorizon
+{
+	// Ray march per azimuth; stops early once even the highest grid cell cannot raise the horizon
+	static void ComputeRows(const FVoxelHeightSnapshot& Snapshot, int32 NumAzimuths, int32 MaxDistance, const FIntRect& Rect, float* OutAngles)
+	{
+		const int32 SizeX = Snapshot.GridSize.X;
+		const int32 SizeY = Snapshot.GridSize.Y;
+		const float* Heights = Snapshot.MaxHeightCm.GetData();
+		const float CellSizeCm = Snapshot.CellSizeCm;
+
+		float GlobalMaxZ = -FLT_MAX;
+		for (const float Z : Snapshot.MaxHeightCm)
+		{
+			GlobalMaxZ = FMath::Max(GlobalMaxZ, Z);
+		}
+
+		TArray<FVector2f> Dirs;
+		Dirs.SetNumUninitialized(NumAzimuths);
+		for (int32 a = 0; a < NumAzimuths; ++a)
+		{
+			const float Angle = 2.0f * PI * (float)a / (float)NumAzimuths;
+			Dirs[a] = FVector2f(FMath::Cos(Angle), FMath::Sin(Angle));
+		}
+
+		ParallelFor(Rect.Height(), [&](int32 Row)
+		{
+			const int32 Y = Rect.Min.Y + Row;
+			for (int32 X = Rect.Min.X; X < Rect.Max.X; ++X)
+			{
+				float* Out = OutAngles + (int64)(X + Y * SizeX) * NumAzimuths;
+				const float Z0 = Heights[X + Y * SizeX];
+
+				// Cells without terrain: flat horizon
+				if (Z0 <= -1e20f)
+				{
+					for (int32 a = 0; a < NumAzimuths; ++a) Out[a] = 0.0f;
+					continue;
+				}
+
+				for (int32 a = 0; a < NumAzimuths; ++a)
+				{
+					float BestSlope = -FLT_MAX;
+					for (int32 Step = 1; Step <= MaxDistance; ++Step)
+					{
+						const float Dist = (float)Step * CellSizeCm;
+						if ((GlobalMaxZ - Z0) / Dist <= BestSlope)
+							break;
+
+						const int32 SX = FMath::RoundToInt((float)X + Dirs[a].X * (float)Step);
+						const int32 SY = FMath::RoundToInt((float)Y + Dirs[a].Y * (float)Step);
+						if (SX < 0 || SY < 0 || SX >= SizeX || SY >= SizeY)
+							break;
+
+						const float Z = Heights[SX + SY * SizeX];
+						if (Z > -1e20f)
+						{
+							BestSlope = FMath::Max(BestSlope, (Z - Z0) / Dist);
+						}
+					}
+
+					// Nothing sampled (grid edge): flat horizon
+					Out[a] = BestSlope > -FLT_MAX ? FMath::Atan(BestSlope) : 0.0f;
+				}
+			}
+		});
+	}
+}
+
+bool FVoxelHorizonMap::Compute(const FVoxelHeightSnapshot& Snapshot, const FVoxelHorizonSettings& Settings, TArray<float>& OutAngles)
+{
+	// Guard: baked grid
+	if (!Snapshot.IsValid())
+		return false;
+
+	const int32 NumAzimuths = FMath::Clamp(Settings.NumAzimuths, 4, 64);
+	OutAngles.SetNumUninitialized(Snapshot.GridSize.X * Snapshot.GridSize.Y * NumAzimuths);
+
+	VoxelHorizon::ComputeRows(Snapshot, NumAzimuths, FMath::Max(1, Settings.MaxDistanceCells),
+		FIntRect(FIntPoint(0, 0), Snapshot.GridSize), OutAngles.GetData());
+	return true;
+}
+
+bool FVoxelHorizonMap::UpdateRegion(const FVoxelHeightSnapshot& Snapshot, const FVoxelHorizonSettings& Settings, const FIntRect& DirtyCells, TArray<float>& InOutAngles)
+{
+	const int32 NumAzimuths = FMath::Clamp(Settings.NumAzimuths, 4, 64);
+	const int32 MaxDistance = FMath::Max(1, Settings.MaxDistanceCells);
+
+	// Guard: baked grid + existing map with same layout
+	if (!Snapshot.IsValid() || InOutAngles.Num() != Snapshot.GridSize.X * Snapshot.GridSize.Y * NumAzimuths)
+		return false;
+
+	// Any cell within search distance may have a changed horizon
+	const FIntRect Rect(
+		FIntPoint(FMath::Clamp(DirtyCells.Min.X - MaxDistance, 0, Snapshot.GridSize.X), FMath::Clamp(DirtyCells.Min.Y - MaxDistance, 0, Snapshot.GridSize.Y)),
+		FIntPoint(FMath::Clamp(DirtyCells.Max.X + MaxDistance, 0, Snapshot.GridSize.X), FMath::Clamp(DirtyCells.Max.Y + MaxDistance, 0, Snapshot.GridSize.Y)));
+	if (Rect.Min.X >= Rect.Max.X || Rect.Min.Y >= Rect.Max.Y)
+		return true;
+
+	VoxelHorizon::ComputeRows(Snapshot, NumAzimuths, MaxDistance, Rect, InOutAngles.GetData());
+	return true;
+}
+
+float FVoxelHorizonMap::SampleHorizon(const float* CellAngles, int32 NumAzimuths, float AzimuthRad)
+{
+	const float Sector = 2.0f * PI / (float)NumAzimuths;
+	const float F = FMath::Fmod(FMath::Fmod(AzimuthRad, 2.0f * PI) + 2.0f * PI, 2.0f * PI) / Sector;
+	const int32 I0 = FMath::Min(FMath::FloorToInt(F), NumAzimuths - 1);
+	const int32 I1 = (I0 + 1) % NumAzimuths;
+	return FMath::Lerp(CellAngles[I0], CellAngles[I1], F - (float)I0);
+}
+
+float FVoxelHorizonMap::SkyVisibility(const float* CellAngles, int32 NumAzimuths)
+{
+	float Sum = 0.0f;
+	for (int32 a = 0; a < NumAzimuths; ++a)
+	{
+		Sum += FMath::Sin(FMath::Max(0.0f, CellAngles[a]));
+	}
+	return 1.0f - Sum / (float)NumAzimuths;
+}
@@ -0,0 +1,567 @@
+// Hierarchical pathfinding (HPA*) over the baked height grid
+// Cluster/portal abstraction with slope-based edge costs, incremental cluster updates
+
+#include "VoxelPathfinder.h"
+
+#include "VoxelHeightCache.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+
+namespace VoxelPath
+{
+	// Entrances at least this long get a portal at each end instead of one in the middle
+	static constexpr int32 LongEntranceLength = 6;
+
+	// Neighbour offsets (4 orthogonal first, then diagonals)
+	static const FIntPoint Neighbours[8] = {
+		{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+		{ 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 }
+	};
+
+	// Open-list entry (min-heap by F)
+	struct FOpenEntry
+	{
+		int32 Id;
+		float F;
+	};
+
+	struct FOpenLess
+	{
+		bool operator()(const FOpenEntry& A, const FOpenEntry& B) const { return A.F < B.F; }
+	};
+
+	// Border ids: cluster * 2 + 0 (right neighbour) / + 1 (bottom neighbour)
+	static int32 BorderId(int32 Cluster, bool bBottom) { return Cluster * 2 + (bBottom ? 1 : 0); }
+}
+
+// Full build: every cluster dirty
+void FVoxelPathfinder::Build(const FVoxelHeightSnapshot& Snapshot, const FVoxelPathSettings& InSettings)
+{
+	FWriteScopeLock WriteLock(Lock);
+
+	Settings = InSettings;
+	Settings.ClusterSize = FMath::Max(4, Settings.ClusterSize);
+	MaxSlope = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(Settings.MaxSlopeDegrees, 0.0f, 89.0f)));
+
+	GridSize = Snapshot.GridSize;
+	CellSizeCm = Snapshot.CellSizeCm;
+	Heights = Snapshot.MaxHeightCm;
+
+	NumClusters = FIntPoint(
+		FMath::DivideAndRoundUp(FMath::Max(GridSize.X, 0), Settings.ClusterSize),
+		FMath::DivideAndRoundUp(FMath::Max(GridSize.Y, 0), Settings.ClusterSize));
+
+	ClusterNodes.Reset();
+	ClusterNodes.SetNum(NumClusters.X * NumClusters.Y);
+	Nodes.Reset();
+	FreeNodes.Reset();
+
+	if (!Snapshot.IsValid())
+		return;
+
+	TArray<int32> AllClusters;
+	AllClusters.SetNumUninitialized(ClusterNodes.Num());
+	for (int32 i = 0; i < AllClusters.Num(); ++i) AllClusters[i] = i;
+
+	RebuildClusters(AllClusters);
+}
+
+// Incremental update after re-baking a region
+void FVoxelPathfinder::UpdateRegion(const FVoxelHeightSnapshot& Snapshot, const FIntRect& DirtyCells)
+{
+	// Grid layout changed: full rebuild
+	if (Snapshot.GridSize != GridSize || Snapshot.CellSizeCm != CellSizeCm)
+	{
+		const FVoxelPathSettings CurrentSettings = Settings;
+		Build(Snapshot, CurrentSettings);
+		return;
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+
+	// Step costs across the rect edge change too: grow by one cell
+	const int32 MinX = FMath::Clamp(DirtyCells.Min.X - 1, 0, GridSize.X);
+	const int32 MinY = FMath::Clamp(DirtyCells.Min.Y - 1, 0, GridSize.Y);
+	const int32 MaxX = FMath::Clamp(DirtyCells.Max.X + 1, 0, GridSize.X);
+	const int32 MaxY = FMath::Clamp(DirtyCells.Max.Y + 1, 0, GridSize.Y);
+	if (MinX >= MaxX || MinY >= MaxY)
+		return;
+
+	// Copy re-baked heights
+	for (int32 Y = MinY; Y < MaxY; ++Y)
+	{
+		const int32 Row = Y * GridSize.X;
+		FMemory::Memcpy(Heights.GetData() + Row + MinX, Snapshot.MaxHeightCm.GetData() + Row + MinX, (MaxX - MinX) * sizeof(float));
+	}
+
+	// Clusters overlapping the dirty area
+	TArray<int32> Dirty;
+	for (int32 CY = MinY / Settings.ClusterSize; CY <= (MaxY - 1) / Settings.ClusterSize; ++CY)
+	{
+		for (int32 CX = MinX / Settings.ClusterSize; CX <= (MaxX - 1) / Settings.ClusterSize; ++CX)
+		{
+			Dirty.Add(CX + CY * NumClusters.X);
+		}
+	}
+	RebuildClusters(Dirty);
+}
+
+bool FVoxelPathfinder::IsBuilt() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return ClusterNodes.Num() > 0 && Heights.Num() == GridSize.X * GridSize.Y;
+}
+
+int32 FVoxelPathfinder::GetNumNodes() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Nodes.Num() - FreeNodes.Num();
+}
+
+// Slope-weighted move cost between neighbour cells
+float FVoxelPathfinder::StepCost(int32 FromCell, int32 ToCell, bool bDiagonal) const
+{
+	const float HA = Heights[FromCell];
+	const float HB = Heights[ToCell];
+	if (HA <= -1e20f || HB <= -1e20f)
+		return -1.0f;
+
+	const float Dist = bDiagonal ? CellSizeCm * UE_SQRT_2 : CellSizeCm;
+	const float Slope = FMath::Abs(HB - HA) / Dist;
+	if (Slope > MaxSlope)
+		return -1.0f;
+
+	return Dist * (1.0f + Settings.SlopeCostFactor * Slope);
+}
+
+FIntRect FVoxelPathfinder::GetClusterRect(int32 Cluster) const
+{
+	const int32 CX = Cluster % NumClusters.X;
+	const int32 CY = Cluster / NumClusters.X;
+	const FIntPoint Min(CX * Settings.ClusterSize, CY * Settings.ClusterSize);
+	const FIntPoint Max(FMath::Min(Min.X + Settings.ClusterSize, GridSize.X), FMath::Min(Min.Y + Settings.ClusterSize, GridSize.Y));
+	return FIntRect(Min, Max);
+}
+
+int32 FVoxelPathfinder::GetClusterOfCell(int32 X, int32 Y) const
+{
+	return (X / Settings.ClusterSize) + (Y / Settings.ClusterSize) * NumClusters.X;
+}
+
+// Dijkstra within rect (local arrays indexed relative to rect)
+void FVoxelPathfinder::SearchInRect(const FIntRect& Rect, int32 StartCell, int32 StopCell, TArray<float>& OutCost, TArray<int32>& OutParent) const
+{
+	const int32 W = Rect.Width();
+	const int32 H = Rect.Height();
+
+	OutCost.Init(FLT_MAX, W * H);
+	OutParent.Init(INDEX_NONE, W * H);
+
+	auto ToLocal = [&](int32 Cell) { return (Cell % GridSize.X - Rect.Min.X) + (Cell / GridSize.X - Rect.Min.Y) * W; };
+
+	TArray<VoxelPath::FOpenEntry> Open;
+	OutCost[ToLocal(StartCell)] = 0.0f;
+	Open.HeapPush({ StartCell, 0.0f }, VoxelPath::FOpenLess());
+
+	const int32 NumDirs = Settings.bAllowDiagonal ? 8 : 4;
+
+	while (Open.Num() > 0)
+	{
+		VoxelPath::FOpenEntry Top;
+		Open.HeapPop(Top, VoxelPath::FOpenLess(), EAllowShrinking::No);
+
+		const int32 Local = ToLocal(Top.Id);
+		if (Top.F > OutCost[Local])
+			continue;
+		if (Top.Id == StopCell)
+			break;
+
+		const int32 X = Top.Id % GridSize.X;
+		const int32 Y = Top.Id / GridSize.X;
+
+		for (int32 d = 0; d < NumDirs; ++d)
+		{
+			const int32 NX = X + VoxelPath::Neighbours[d].X;
+			const int32 NY = Y + VoxelPath::Neighbours[d].Y;
+			if (NX < Rect.Min.X || NY < Rect.Min.Y || NX >= Rect.Max.X || NY >= Rect.Max.Y)
+				continue;
+
+			const int32 NCell = NX + NY * GridSize.X;
+			const float Step = StepCost(Top.Id, NCell, d >= 4);
+			if (Step < 0.0f)
+				continue;
+
+			const int32 NLocal = ToLocal(NCell);
+			const float NewCost = Top.F + Step;
+			if (NewCost < OutCost[NLocal])
+			{
+				OutCost[NLocal] = NewCost;
+				OutParent[NLocal] = Top.Id;
+				Open.HeapPush({ NCell, NewCost }, VoxelPath::FOpenLess());
+			}
+		}
+	}
+}
+
+// Walk local parents back from goal and append cells in forward order
+void FVoxelPathfinder::AppendLocalPath(const FIntRect& Rect, int32 StartCell, int32 GoalCell, const TArray<int32>& Parent, TArray<FIntPoint>& OutCells) const
+{
+	const int32 W = Rect.Width();
+	const int32 FirstNew = OutCells.Num();
+
+	for (int32 Cell = GoalCell; Cell != StartCell && Cell != INDEX_NONE;
+		Cell = Parent[(Cell % GridSize.X - Rect.Min.X) + (Cell / GridSize.X - Rect.Min.Y) * W])
+	{
+		OutCells.Add(FIntPoint(Cell % GridSize.X, Cell / GridSize.X));
+	}
+
+	// Reverse appended segment into start -> goal order
+	for (int32 i = FirstNew, j = OutCells.Num() - 1; i < j; ++i, --j)
+	{
+		OutCells.Swap(i, j);
+	}
+}
+
+int32 FVoxelPathfinder::AddNode(int32 Cell, int32 Cluster, int32 Border)
+{
+	const int32 Id = FreeNodes.Num() > 0 ? FreeNodes.Pop(EAllowShrinking::No) : Nodes.AddDefaulted();
+	FNode& Node = Nodes[Id];
+	Node.Cell = Cell;
+	Node.Cluster = Cluster;
+	Node.Border = Border;
+	Node.Edges.Reset();
+	Node.bAlive = true;
+	ClusterNodes[Cluster].Add(Id);
+	return Id;
+}
+
+// Portals along the border to the right (vertical line) or bottom (horizontal line) neighbour
+void FVoxelPathfinder::BuildBorderEntrances(int32 Border)
+{
+	const int32 Cluster = Border / 2;
+	const bool bBottom = (Border % 2) == 1;
+	const int32 CX = Cluster % NumClusters.X;
+	const int32 CY = Cluster / NumClusters.X;
+
+	// Guard: no neighbour on this side
+	if ((!bBottom && CX + 1 >= NumClusters.X) || (bBottom && CY + 1 >= NumClusters.Y))
+		return;
+
+	const int32 Other = bBottom ? Cluster + NumClusters.X : Cluster + 1;
+	const FIntRect Rect = GetClusterRect(Cluster);
+
+	// Walk along the border: cell A in this cluster, cell B across the border
+	const int32 Length = bBottom ? Rect.Width() : Rect.Height();
+	auto CellPair = [&](int32 i, int32& OutA, int32& OutB)
+	{
+		const int32 AX = bBottom ? Rect.Min.X + i : Rect.Max.X - 1;
+		const int32 AY = bBottom ? Rect.Max.Y - 1 : Rect.Min.Y + i;
+		OutA = AX + AY * GridSize.X;
+		OutB = bBottom ? OutA + GridSize.X : OutA + 1;
+	};
+
+	auto AddPortal = [&](int32 i)
+	{
+		int32 A, B;
+		CellPair(i, A, B);
+		const float Cost = StepCost(A, B, false);
+		const int32 NodeA = AddNode(A, Cluster, Border);
+		const int32 NodeB = AddNode(B, Other, Border);
+		Nodes[NodeA].Edges.Add({ NodeB, Cost, true });
+		Nodes[NodeB].Edges.Add({ NodeA, Cost, true });
+	};
+
+	int32 RunStart = INDEX_NONE;
+	for (int32 i = 0; i <= Length; ++i)
+	{
+		bool bOpen = false;
+		if (i < Length)
+		{
+			int32 A, B;
+			CellPair(i, A, B);
+			bOpen = StepCost(A, B, false) >= 0.0f;
+		}
+
+		if (bOpen && RunStart == INDEX_NONE)
+		{
+			RunStart = i;
+		}
+		else if (!bOpen && RunStart != INDEX_NONE)
+		{
+			// Close entrance [RunStart, i - 1]
+			const int32 RunEnd = i - 1;
+			if (RunEnd - RunStart + 1 >= VoxelPath::LongEntranceLength)
+			{
+				AddPortal(RunStart);
+				AddPortal(RunEnd);
+			}
+			else
+			{
+				AddPortal((RunStart + RunEnd) / 2);
+			}
+			RunStart = INDEX_NONE;
+		}
+	}
+}
+
+// Intra-cluster edges: local Dijkstra from every portal of the cluster
+void FVoxelPathfinder::BuildIntraEdges(int32 Cluster)
+{
+	const TArray<int32>& Portals = ClusterNodes[Cluster];
+	const FIntRect Rect = GetClusterRect(Cluster);
+	const int32 W = Rect.Width();
+
+	TArray<float> Cost;
+	TArray<int32> Parent;
+
+	for (const int32 From : Portals)
+	{
+		FNode& Node = Nodes[From];
+		Node.Edges.RemoveAll([](const FEdge& E) { return !E.bInter; });
+
+		SearchInRect(Rect, Node.Cell, INDEX_NONE, Cost, Parent);
+
+		for (const int32 To : Portals)
+		{
+			if (To == From)
+				continue;
+
+			const int32 ToCell = Nodes[To].Cell;
+			const float C = Cost[(ToCell % GridSize.X - Rect.Min.X) + (ToCell / GridSize.X - Rect.Min.Y) * W];
+			if (C < FLT_MAX)
+			{
+				Node.Edges.Add({ To, C, false });
+			}
+		}
+	}
+}
+
+// Rebuild borders touching dirty clusters, then intra edges of every cluster on those borders
+void FVoxelPathfinder::RebuildClusters(const TArray<int32>& DirtyClusters)
+{
+	TSet<int32> Borders;
+	TSet<int32> Affected;
+
+	for (const int32 Cluster : DirtyClusters)
+	{
+		const int32 CX = Cluster % NumClusters.X;
+		const int32 CY = Cluster / NumClusters.X;
+
+		Affected.Add(Cluster);
+		Borders.Add(VoxelPath::BorderId(Cluster, false));
+		Borders.Add(VoxelPath::BorderId(Cluster, true));
+
+		if (CX > 0)
+		{
+			Borders.Add(VoxelPath::BorderId(Cluster - 1, false));
+			Affected.Add(Cluster - 1);
+		}
+		if (CY > 0)
+		{
+			Borders.Add(VoxelPath::BorderId(Cluster - NumClusters.X, true));
+			Affected.Add(Cluster - NumClusters.X);
+		}
+		if (CX + 1 < NumClusters.X) Affected.Add(Cluster + 1);
+		if (CY + 1 < NumClusters.Y) Affected.Add(Cluster + NumClusters.X);
+	}
+
+	// Drop portals created by rebuilt borders
+	for (const int32 Cluster : Affected)
+	{
+		ClusterNodes[Cluster].RemoveAll([&](int32 Id)
+		{
+			FNode& Node = Nodes[Id];
+			if (!Borders.Contains(Node.Border))
+				return false;
+
+			Node.bAlive = false;
+			Node.Edges.Reset();
+			FreeNodes.Add(Id);
+			return true;
+		});
+	}
+
+	// New portals (serial: allocates nodes)
+	for (const int32 Border : Borders)
+	{
+		BuildBorderEntrances(Border);
+	}
+
+	// Intra edges per cluster in parallel (each task touches only its own portals)
+	const TArray<int32> AffectedList = Affected.Array();
+	ParallelFor(AffectedList.Num(), [&](int32 i)
+	{
+		BuildIntraEdges(AffectedList[i]);
+	});
+}
+
+// HPA* query: connect start/goal to their cluster portals, search abstract graph, refine per segment
+bool FVoxelPathfinder::FindPath(const FIntPoint& Start, const FIntPoint& Goal, FVoxelPathResult& OutResult) const
+{
+	FReadScopeLock ReadLock(Lock);
+
+	OutResult = FVoxelPathResult();
+
+	// Guard: built graph + cells inside grid
+	auto Inside = [this](const FIntPoint& P) { return P.X >= 0 && P.Y >= 0 && P.X < GridSize.X && P.Y < GridSize.Y; };
+	if (ClusterNodes.Num() == 0 || !Inside(Start) || !Inside(Goal))
+		return false;
+
+	const int32 StartCell = Start.X + Start.Y * GridSize.X;
+	const int32 GoalCell = Goal.X + Goal.Y * GridSize.X;
+	const int32 StartCluster = GetClusterOfCell(Start.X, Start.Y);
+	const int32 GoalCluster = GetClusterOfCell(Goal.X, Goal.Y);
+	const FIntRect StartRect = GetClusterRect(StartCluster);
+	const FIntRect GoalRect = GetClusterRect(GoalCluster);
+
+	TArray<float> LocalCost;
+	TArray<int32> LocalParent;
+
+	OutResult.Cells.Add(Start);
+	if (StartCell == GoalCell)
+		return true;
+
+	// Same cluster: try a direct local search first
+	if (StartCluster == GoalCluster)
+	{
+		SearchInRect(StartRect, StartCell, GoalCell, LocalCost, LocalParent);
+		const int32 W = StartRect.Width();
+		const float C = LocalCost[(Goal.X - StartRect.Min.X) + (Goal.Y - StartRect.Min.Y) * W];
+		if (C < FLT_MAX)
+		{
+			AppendLocalPath(StartRect, StartCell, GoalCell, LocalParent, OutResult.Cells);
+			OutResult.Cost = C;
+			return true;
+		}
+	}
+
+	// Start -> portals of start cluster
+	TMap<int32, float> StartLinks;
+	SearchInRect(StartRect, StartCell, INDEX_NONE, LocalCost, LocalParent);
+	for (const int32 Id : ClusterNodes[StartCluster])
+	{
+		const int32 Cell = Nodes[Id].Cell;
+		const float C = LocalCost[(Cell % GridSize.X - StartRect.Min.X) + (Cell / GridSize.X - StartRect.Min.Y) * StartRect.Width()];
+		if (C < FLT_MAX) StartLinks.Add(Id, C);
+	}
+
+	// Portals of goal cluster -> goal (costs are symmetric)
+	TMap<int32, float> GoalLinks;
+	SearchInRect(GoalRect, GoalCell, INDEX_NONE, LocalCost, LocalParent);
+	for (const int32 Id : ClusterNodes[GoalCluster])
+	{
+		const int32 Cell = Nodes[Id].Cell;
+		const float C = LocalCost[(Cell % GridSize.X - GoalRect.Min.X) + (Cell / GridSize.X - GoalRect.Min.Y) * GoalRect.Width()];
+		if (C < FLT_MAX) GoalLinks.Add(Id, C);
+	}
+
+	if (StartLinks.Num() == 0 || GoalLinks.Num() == 0)
+		return false;
+
+	// Octile distance (admissible: slope factor only increases cost)
+	auto Heuristic = [&](int32 Cell)
+	{
+		const int32 DX = FMath::Abs(Cell % GridSize.X - Goal.X);
+		const int32 DY = FMath::Abs(Cell / GridSize.X - Goal.Y);
+		const float Diag = Settings.bAllowDiagonal ? (float)FMath::Min(DX, DY) : 0.0f;
+		const float Straight = (float)(DX + DY) - (Settings.bAllowDiagonal ? 2.0f * Diag : 0.0f);
+		return (Straight + Diag * UE_SQRT_2) * CellSizeCm;
+	};
+
+	// Abstract A* (virtual goal id = -2)
+	constexpr int32 GoalId = -2;
+	TMap<int32, float> GScore;
+	TMap<int32, int32> CameFrom;
+	TArray<VoxelPath::FOpenEntry> Open;
+
+	for (const TPair<int32, float>& Link : StartLinks)
+	{
+		GScore.Add(Link.Key, Link.Value);
+		CameFrom.Add(Link.Key, INDEX_NONE);
+		Open.HeapPush({ Link.Key, Link.Value + Heuristic(Nodes[Link.Key].Cell) }, VoxelPath::FOpenLess());
+	}
+
+	float GoalCost = FLT_MAX;
+	while (Open.Num() > 0)
+	{
+		VoxelPath::FOpenEntry Top;
+		Open.HeapPop(Top, VoxelPath::FOpenLess(), EAllowShrinking::No);
+
+		if (Top.Id == GoalId)
+			break;
+
+		const float G = GScore.FindChecked(Top.Id);
+		if (Top.F > G + Heuristic(Nodes[Top.Id].Cell) + KINDA_SMALL_NUMBER)
+			continue;
+
+		OutResult.ExpandedNodes++;
+
+		// Link into goal
+		if (const float* ToGoal = GoalLinks.Find(Top.Id))
+		{
+			if (G + *ToGoal < GoalCost)
+			{
+				GoalCost = G + *ToGoal;
+				CameFrom.Add(GoalId, Top.Id);
+				Open.HeapPush({ GoalId, GoalCost }, VoxelPath::FOpenLess());
+			}
+		}
+
+		for (const FEdge& Edge : Nodes[Top.Id].Edges)
+		{
+			const float NewG = G + Edge.Cost;
+			const float* OldG = GScore.Find(Edge.To);
+			if (!OldG || NewG < *OldG)
+			{
+				GScore.Add(Edge.To, NewG);
+				CameFrom.Add(Edge.To, Top.Id);
+				Open.HeapPush({ Edge.To, NewG + Heuristic(Nodes[Edge.To].Cell) }, VoxelPath::FOpenLess());
+			}
+		}
+	}
+
+	if (GoalCost == FLT_MAX)
+		return false;
+
+	// Abstract node chain start -> goal
+	TArray<int32> Chain;
+	for (int32 Id = CameFrom.FindChecked(GoalId); Id != INDEX_NONE; Id = CameFrom.FindChecked(Id))
+	{
+		Chain.Add(Id);
+	}
+	Algo::Reverse(Chain);
+
+	// Refine: local search inside a cluster, inter edges are single steps
+	int32 CurrentCell = StartCell;
+	int32 CurrentCluster = StartCluster;
+	auto RefineTo = [&](int32 TargetCell, int32 Cluster)
+	{
+		const FIntRect Rect = GetClusterRect(Cluster);
+		SearchInRect(Rect, CurrentCell, TargetCell, LocalCost, LocalParent);
+		AppendLocalPath(Rect, CurrentCell, TargetCell, LocalParent, OutResult.Cells);
+		CurrentCell = TargetCell;
+	};
+
+	for (const int32 Id : Chain)
+	{
+		const FNode& Node = Nodes[Id];
+		if (Node.Cluster != CurrentCluster)
+		{
+			// Inter edge: adjacent cell across the border
+			OutResult.Cells.Add(FIntPoint(Node.Cell % GridSize.X, Node.Cell / GridSize.X));
+			CurrentCell = Node.Cell;
+			CurrentCluster = Node.Cluster;
+		}
+		else if (Node.Cell != CurrentCell)
+		{
+			RefineTo(Node.Cell, CurrentCluster);
+		}
+	}
+	if (CurrentCell != GoalCell)
+	{
+		RefineTo(GoalCell, GoalCluster);
+	}
+
+	OutResult.Cost = GoalCost;
+	return true;
+}
@@ -0,0 +1,134 @@
+// Viewshed (line-of-sight visibility) from an observer on the baked height grid
+// Radial ring sweep (XDraw) per octant, octants run in parallel
+
+#include "VoxelViewshed.h"
+
+#include "VoxelHeightCache.h"
+#include "Async/ParallelFor.h"
+
+namespace VoxelViewshed
+{
+	// Octant axes: cell offset = Ring * Major + Step * Minor (0 <= Step <= Ring)
+	struct FOctant
+	{
+		int32 MajorX, MajorY, MinorX, MinorY;
+	};
+
+	static const FOctant Octants[8] = {
+		{  1,  0,  0,  1 },
+		{  0,  1,  1,  0 },
+		{  0,  1, -1,  0 },
+		{ -1,  0,  0,  1 },
+		{ -1,  0,  0, -1 },
+		{  0, -1, -1,  0 },
+		{  0, -1,  1,  0 },
+		{  1,  0,  0, -1 }
+	};
+
+	// Horizon slope for "nothing blocks yet"
+	static constexpr float OpenSlope = -1e30f;
+}
+
+// XDraw: each ring cell inherits the horizon slope interpolated from the previous ring
+bool FVoxelViewshed::Compute(const FVoxelHeightSnapshot& Snapshot, const FVoxelViewshedSettings& Settings, FVoxelViewshedResult& OutResult)
+{
+	// Guard: baked grid
+	if (!Snapshot.IsValid())
+		return false;
+
+	const int32 ObsX = FMath::FloorToInt((Settings.ObserverWorld.X - Snapshot.GridMinWorld.X) / Snapshot.CellSizeCm);
+	const int32 ObsY = FMath::FloorToInt((Settings.ObserverWorld.Y - Snapshot.GridMinWorld.Y) / Snapshot.CellSizeCm);
+
+	// Guard: observer on valid terrain
+	if (!Snapshot.IsValidCell(ObsX, ObsY))
+		return false;
+	const float GroundZ = Snapshot.MaxHeightCm[Snapshot.ToIndex(ObsX, ObsY)];
+	if (GroundZ <= -1e20f)
+		return false;
+
+	const float EyeZ = GroundZ + Settings.ObserverHeightCm;
+	const float TargetHeightCm = Settings.TargetHeightCm;
+	const float CellSizeCm = Snapshot.CellSizeCm;
+	const int32 R = FMath::Max(1, Settings.MaxRadiusCells);
+	const int32 Window = 2 * R + 1;
+
+	OutResult.ObserverCell = FIntPoint(ObsX, ObsY);
+	OutResult.Radius = R;
+	OutResult.Visible.SetNumZeroed(Window * Window);
+	OutResult.NumVisible = 0;
+
+	uint8* Visible = OutResult.Visible.GetData();
+	Visible[R + R * Window] = 1;
+
+	int32 VisiblePerOctant[8] = {};
+
+	ParallelFor(8, [&](int32 OctantIndex)
+	{
+		const VoxelViewshed::FOctant& O = VoxelViewshed::Octants[OctantIndex];
+
+		// Shared boundary cells are written by exactly one octant:
+		// even octants own Step = 0 (axis), odd octants own Step = Ring (diagonal)
+		const bool bEven = (OctantIndex % 2) == 0;
+
+		// Horizon slope per step on previous and current ring
+		TArray<float> Prev, Cur;
+		Prev.Init(VoxelViewshed::OpenSlope, R + 1);
+		Cur.Init(VoxelViewshed::OpenSlope, R + 1);
+
+		int32 LocalVisible = 0;
+
+		for (int32 Ring = 1; Ring <= R; ++Ring)
+		{
+			for (int32 Step = 0; Step <= Ring; ++Step)
+			{
+				// Horizon slope where the line to the observer crosses the previous ring
+				float HorizonSlope = VoxelViewshed::OpenSlope;
+				if (Ring > 1)
+				{
+					const float T = (float)Step * (float)(Ring - 1) / (float)Ring;
+					const int32 S0 = FMath::FloorToInt(T);
+					const int32 S1 = FMath::Min(S0 + 1, Ring - 1);
+					HorizonSlope = FMath::Lerp(Prev[S0], Prev[S1], T - (float)S0);
+				}
+
+				const int32 DX = Ring * O.MajorX + Step * O.MinorX;
+				const int32 DY = Ring * O.MajorY + Step * O.MinorY;
+				const int32 CellX = ObsX + DX;
+				const int32 CellY = ObsY + DY;
+
+				// Cells outside grid or without terrain never block
+				float CellSlope = VoxelViewshed::OpenSlope;
+				bool bCellVisible = false;
+				if (Snapshot.IsValidCell(CellX, CellY))
+				{
+					const float Z = Snapshot.MaxHeightCm[Snapshot.ToIndex(CellX, CellY)];
+					if (Z > -1e20f)
+					{
+						const float DistCm = FMath::Sqrt((float)(Ring * Ring + Step * Step)) * CellSizeCm;
+						CellSlope = (Z - EyeZ) / DistCm;
+						bCellVisible = (Z + TargetHeightCm - EyeZ) / DistCm >= HorizonSlope;
+					}
+				}
+				Cur[Step] = FMath::Max(CellSlope, HorizonSlope);
+
+				// Write only owned cells inside view radius
+				const bool bOwned = bEven ? (Step < Ring) : (Step > 0);
+				if (bOwned && bCellVisible && Ring * Ring + Step * Step <= R * R)
+				{
+					Visible[(DX + R) + (DY + R) * Window] = 1;
+					LocalVisible++;
+				}
+			}
+			Swap(Prev, Cur);
+		}
+
+		VisiblePerOctant[OctantIndex] = LocalVisible;
+	});
+
+	OutResult.NumVisible = 1;
+	for (const int32 Count : VisiblePerOctant)
+	{
+		OutResult.NumVisible += Count;
+	}
+	return true;
+}
@@ -0,0 +1,36 @@
+// Local derived-data store for baked voxel height results
+// Computes content hashes for bakes and saves/loads results keyed by hash
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ALandscapeProxy;
+class UVoxelGridConfig;
+class UVoxelHeightCache;
+
+class ASP_OSWALD_LEANDRO_API FVoxelBakeStore
+{
+public:
+	// Compute content hash over landscape heights, config parameters and grid layout
+	// Empty if the landscape height data cannot be read (non-editor builds): store must not be used
+	static FString ComputeBakeHash(
+		const ALandscapeProxy* Landscape,
+		const UVoxelGridConfig* Config,
+		const FVector& GridMinWorld,
+		const FIntPoint& GridSize,
+		float CellSizeCm);
+
+	// Load previously stored bake result into cache (false if not found or mismatched)
+	static bool Load(const FString& BakeHash, UVoxelHeightCache* Cache);
+
+	// Save baked cache result under its hash
+	static bool Save(const FString& BakeHash, const UVoxelHeightCache* Cache);
+
+	// Directory holding stored bake results (Saved/VoxelBakeCache)
+	static FString GetStoreDir();
+
+private:
+	// File path for a single stored bake result
+	static FString GetEntryPath(const FString& BakeHash);
+};
@@ -0,0 +1,98 @@
+// Elevation contour (isoline) extraction from the baked height grid
+// Tile-parallel marching squares, polylines stitched across tiles, dirty tiles re-extracted only
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVoxelHeightSnapshot;
+
+// Contour extraction parameters
+struct ASP_OSWALD_LEANDRO_API FVoxelContourSettings
+{
+	// Level spacing (cm)
+	float IntervalCm = 1000.0f;
+
+	// Reference level in world Z (cm), usually the sea level
+	float BaseLevelCm = 0.0f;
+
+	// Also extract levels below the reference level
+	bool bIncludeBelowBase = false;
+
+	// Tile edge length (lattice squares) for parallel extraction
+	int32 TileSize = 64;
+};
+
+// Compact polyline buffers (closed polylines repeat their first point at the end)
+struct ASP_OSWALD_LEANDRO_API FVoxelContourSet
+{
+	// All polyline points in world XY (cm)
+	TArray<FVector2f> Points;
+
+	// First point of each polyline; one extra trailing entry = Points.Num()
+	TArray<int32> PolylineStarts;
+
+	// Level of each polyline in world Z (cm)
+	TArray<float> PolylineLevels;
+
+	int32 NumPolylines() const { return PolylineLevels.Num(); }
+
+	// Point range of a polyline
+	TConstArrayView<FVector2f> GetPolyline(int32 Index) const
+	{
+		return TConstArrayView<FVector2f>(Points.GetData() + PolylineStarts[Index], PolylineStarts[Index + 1] - PolylineStarts[Index]);
+	}
+
+	void Reset()
+	{
+		Points.Reset();
+		PolylineStarts.Reset();
+		PolylineLevels.Reset();
+	}
+};
+
+class ASP_OSWALD_LEANDRO_API FVoxelContourExtractor
+{
+public:
+	// Extract all tiles (new levels or grid layout)
+	void Extract(const FVoxelHeightSnapshot& Snapshot, const FVoxelContourSettings& InSettings, FVoxelContourSet& OutContours);
+
+	// Flag tiles touching re-baked cells (min inclusive, max exclusive) for the next Update
+	void MarkDirty(const FIntRect& DirtyCells);
+
+	// Re-extract dirty tiles only and re-stitch (full extract if the grid layout changed)
+	void Update(const FVoxelHeightSnapshot& Snapshot, FVoxelContourSet& OutContours);
+
+	// Extract() has run
+	bool IsExtracted() const { return TileFragments.Num() > 0; }
+
+	const FVoxelContourSettings& GetSettings() const { return Settings; }
+
+	int32 GetNumDirtyTiles() const;
+
+private:
+	// Polyline piece between two lattice-edge crossings (edge id = vertex index * 2 + vertical)
+	struct FFragment
+	{
+		int32 Level = 0;
+		int32 StartEdge = INDEX_NONE;
+		int32 EndEdge = INDEX_NONE;
+		bool bClosed = false;
+		TArray<FVector2f> Points;
+	};
+
+	// Marching squares over one tile, chained into tile-local fragments
+	void ExtractTile(const FVoxelHeightSnapshot& Snapshot, int32 Tile, TArray<FFragment>& OutFragments) const;
+
+	// Re-extract dirty tiles in parallel, then stitch everything
+	void ExtractDirtyAndStitch(const FVoxelHeightSnapshot& Snapshot, FVoxelContourSet& OutContours);
+
+	FVoxelContourSettings Settings;
+	FIntPoint GridSize = FIntPoint(0, 0);
+	FVector GridMinWorld = FVector::ZeroVector;
+	float CellSizeCm = 0.0f;
+
+	FIntPoint NumTiles = FIntPoint(0, 0);
+	TArray<TArray<FFragment>> TileFragments;
+	TBitArray<> DirtyTiles;
+};
@@ -0,0 +1,20 @@
+// Streaming DEM raster importer for voxel height caches
+// Reduces GeoTIFF / 16-bit raw height tiles straight into per-cell max heights (no landscape)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UVoxelGridConfig;
+struct FVoxelHeightSnapshot;
+
+class ASP_OSWALD_LEANDRO_API FVoxelDemImporter
+{
+public:
+	// Compute world-space XY bounds covered by all configured DEM tiles
+	static bool ComputeWorldBounds(const UVoxelGridConfig* Config, FBox2D& OutBounds);
+
+	// Reduce all configured DEM tiles into target cells (target grid must be set up and reset)
+	// Tiles are memory-mapped one at a time; each tile is reduced in parallel over cell rows
+	static bool ImportTiles(const UVoxelGridConfig* Config, FVoxelHeightSnapshot& Target, int64& OutPixelCount);
+};
@@ -0,0 +1,31 @@
+// Distance field to terrain features on the baked height grid
+// Exact Euclidean distance transform (separable: column pass, then row pass), both passes parallel
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGridConfig.h"
+
+struct FVoxelHeightSnapshot;
+
+// Feature predicate for the distance field
+struct ASP_OSWALD_LEANDRO_API FVoxelDistanceFieldSettings
+{
+	EVoxelDistanceFeature Feature = EVoxelDistanceFeature::HeightAbove;
+
+	// HeightAbove: cells with max height >= threshold are features (world Z, cm)
+	float HeightThresholdWorldZCm = 0.0f;
+
+	// SlopeAbove: cells with slope >= threshold are features (degrees)
+	float SlopeDegrees = 30.0f;
+};
+
+class ASP_OSWALD_LEANDRO_API FVoxelDistanceField
+{
+public:
+	// Channel name used when the field is stored in the height cache
+	static const FName DistanceChannel;
+
+	// Per-cell distance (cm, cell centre to nearest feature cell centre; FLT_MAX if no feature exists)
+	static bool Compute(const FVoxelHeightSnapshot& Snapshot, const FVoxelDistanceFieldSettings& Settings, TArray<float>& OutDistanceCm, int64& OutFeatureCells);
+};
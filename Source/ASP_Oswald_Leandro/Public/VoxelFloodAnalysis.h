@@ -0,0 +1,51 @@
+// Sea-level inundation analysis on the baked height grid
+// Finds connected flooded regions for a water level and per-cell water depth
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVoxelHeightSnapshot;
+
+// Flood analysis input
+struct ASP_OSWALD_LEANDRO_API FVoxelFloodSettings
+{
+	// Water surface in world Z (cm)
+	float WaterLevelWorldZCm = 0.0f;
+
+	// Water enters from the grid border (open sea around the terrain; cells without terrain are open water)
+	bool bSeedFromBorder = true;
+
+	// Additional source cells (e.g. lakes, breaches)
+	TArray<FIntPoint> SeedCells;
+
+	// Tile edge length (cells) for parallel labeling
+	int32 TileSize = 64;
+};
+
+// Flood analysis output (per cell, row-major like the height grid)
+struct ASP_OSWALD_LEANDRO_API FVoxelFloodResult
+{
+	// Flooded region index per cell (-1 = dry or not reachable)
+	TArray<int32> RegionId;
+
+	// Water depth per cell in cm (0 = dry)
+	TArray<float> WaterDepthCm;
+
+	// Number of distinct flooded regions
+	int32 NumRegions = 0;
+
+	// Number of flooded terrain cells (no-data cells excluded)
+	int64 FloodedCells = 0;
+};
+
+class ASP_OSWALD_LEANDRO_API FVoxelFloodAnalysis
+{
+public:
+	// Channel names used when results are stored in the height cache
+	static const FName WaterDepthChannel;
+	static const FName FloodRegionChannel;
+
+	// Label cells below water level (tile-parallel connected components) and keep regions reachable from seeds
+	static bool Run(const FVoxelHeightSnapshot& Snapshot, const FVoxelFloodSettings& Settings, FVoxelFloodResult& OutResult);
+};
@@ -6,12 +6,14 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "VoxelContourExtractor.h"
 #include "VoxelGridBaker.generated.h"
 
 class ATerrainReferenceActor;
 class UVoxelGridConfig;
 class UVoxelHeightCache;
 class AHeightQueryProbeActor;
+class FVoxelPathfinder;
 
 UCLASS()
 class ASP_OSWALD_LEANDRO_API AVoxelGridBaker : public AActor
@@ -70,6 +72,119 @@ public:
 	UFUNCTION(CallInEditor, Category="Voxel|Bake")
 	void BakeMaxHeights();
 
+	// Import DemTiles from GridConfig directly into HeightCache (builds grid from DEM extent)
+	UFUNCTION(CallInEditor, Category="Voxel|DEM")
+	void ImportDemTiles();
+
+	// Target cache for coarser grids derived from HeightCache
+	UPROPERTY(EditAnywhere, Category="Output")
+	UVoxelHeightCache* DerivedHeightCache = nullptr;
+
+	// Cell size of derived cache (meters, must be >= baked cell size)
+	UPROPERTY(EditAnywhere, Category="Output", meta=(ClampMin="0.01"))
+	float DerivedCellSizeMeters = 2.0f;
+
+	// Derive coarser cache from baked HeightCache without re-tracing
+	UFUNCTION(CallInEditor, Category="Voxel|Bake")
+	void DeriveCoarserCache();
+
+	
+	// Flood analysis:
+
+	// Water level above sea level (meters)
+	UPROPERTY(EditAnywhere, Category="Flood")
+	float FloodWaterLevelMetersASL = 0.0f;
+
+	// Water enters from the grid border
+	UPROPERTY(EditAnywhere, Category="Flood")
+	bool bFloodFromBorder = true;
+
+	// Optional actors marking additional flood source cells
+	UPROPERTY(EditAnywhere, Category="Flood")
+	TArray<TObjectPtr<AActor>> FloodSeedActors;
+
+	// Compute flooded regions + water depth and store them as cache channels
+	UFUNCTION(CallInEditor, Category="Voxel|Analysis")
+	void RunFloodAnalysis();
+
+	// Viewshed:
+
+	// Observer eye height above ground (meters); observer = PreviewCenterActor or grid center
+	UPROPERTY(EditAnywhere, Category="Viewshed")
+	float ViewshedObserverHeightMeters = 2.0f;
+
+	// View radius in grid cells
+	UPROPERTY(EditAnywhere, Category="Viewshed", meta=(ClampMin="1", ClampMax="2000"))
+	int32 ViewshedRadiusCells = 50;
+
+	// Compute viewshed and draw visible cells
+	UFUNCTION(CallInEditor, Category="Voxel|Analysis")
+	void DebugDrawViewshed();
+
+	// Pathfinding:
+
+	// Cluster edge length in cells for the path abstraction
+	UPROPERTY(EditAnywhere, Category="Path", meta=(ClampMin="4", ClampMax="128"))
+	int32 PathClusterSize = 16;
+
+	// Steepest walkable slope between neighbour cells (degrees)
+	UPROPERTY(EditAnywhere, Category="Path", meta=(ClampMin="0.0", ClampMax="89.0"))
+	float PathMaxSlopeDegrees = 35.0f;
+
+	// Extra cost per unit slope (cost = distance * (1 + factor * slope))
+	UPROPERTY(EditAnywhere, Category="Path", meta=(ClampMin="0.0"))
+	float PathSlopeCostFactor = 2.0f;
+
+	// Path goal for debug queries (start = PreviewCenterActor)
+	UPROPERTY(EditAnywhere, Category="Path")
+	TObjectPtr<AActor> PathGoalActor;
+
+	// Build cluster/portal path graph from HeightCache
+	UFUNCTION(CallInEditor, Category="Voxel|Path")
+	void BuildPathGraph();
+
+	// Query and draw path from PreviewCenterActor to PathGoalActor
+	UFUNCTION(CallInEditor, Category="Voxel|Path")
+	void DebugFindPath();
+
+	// Path service for gameplay/worker-thread queries (null until built)
+	TSharedPtr<FVoxelPathfinder, ESPMode::ThreadSafe> GetPathfinder() const { return Pathfinder; }
+
+	// Contours:
+
+	// Contour line spacing above sea level (m)
+	UPROPERTY(EditAnywhere, Category="Contours", meta=(ClampMin="0.1"))
+	float ContourIntervalMeters = 10.0f;
+
+	// Also extract contours below sea level
+	UPROPERTY(EditAnywhere, Category="Contours")
+	bool bContoursBelowSeaLevel = false;
+
+	// Extract contour lines from HeightCache and draw them
+	UFUNCTION(CallInEditor, Category="Voxel|Contours")
+	void DebugDrawContours();
+
+	// Last extracted contour polylines (kept in sync after re-bakes)
+	const FVoxelContourSet& GetContours() const { return Contours; }
+
+	// Terrain shadow:
+
+	// Sun azimuth (degrees, 0 = +X, 90 = +Y)
+	UPROPERTY(EditAnywhere, Category="Horizon")
+	float SunAzimuthDegrees = 135.0f;
+
+	// Sun elevation above horizontal (degrees)
+	UPROPERTY(EditAnywhere, Category="Horizon", meta=(ClampMin="-90.0", ClampMax="90.0"))
+	float SunElevationDegrees = 20.0f;
+
+	// Radius around PreviewCenterActor / grid center to draw (cells)
+	UPROPERTY(EditAnywhere, Category="Horizon", meta=(ClampMin="1", ClampMax="500"))
+	int32 ShadowDrawRadiusCells = 50;
+
+	// Draw shadowed cells for the sun direction (needs bBakeHorizonMap)
+	UFUNCTION(CallInEditor, Category="Voxel|Horizon")
+	void DebugDrawTerrainShadow();
+
 	
 	// Preview Voxels (nur Debug/Visual):
 
@@ -105,6 +220,13 @@ private:
 	// Validate grid parameters
 	bool IsGridValid() const;
 
+	// Build grid extents and resolution from world-space bounds
+	bool BuildGridFromBounds(const FVector& LMin, const FVector& LMax);
+
+	// Grid extents and resolution for world-space bounds, without touching the baker's grid
+	bool ComputeGridFromBounds(const FVector& LMin, const FVector& LMax,
+		FVector& OutMinWorld, FVector& OutMaxWorld, FIntPoint& OutSize, float& OutCellSizeCm) const;
+
 	// Compute world-space XY bounds for a grid cell
 	void GetCellMinMaxXY(const int32 X, const int32 Y, FVector2D& OutMin, FVector2D& OutMax) const;
 
@@ -114,4 +236,17 @@ private:
 
 	// Resolve preview base Z height (cm)
 	float GetPreviewBaseZCm() const;
+
+	// Update distance field / horizon map / path graph / contours for re-baked cells (if enabled/built)
+	void RefreshDerivedData(const FIntRect& DirtyCells);
+
+	// Update distance field / horizon map channels only (empty DirtyCells: heights unchanged, recompute on changed settings)
+	void RefreshDerivedChannels(const FIntRect& DirtyCells);
+
+	// Hierarchical path graph over baked heights
+	TSharedPtr<FVoxelPathfinder, ESPMode::ThreadSafe> Pathfinder;
+
+	// Contour extraction state (per-tile fragments) and stitched output
+	FVoxelContourExtractor ContourExtractor;
+	FVoxelContourSet Contours;
 };
\ No newline at end of file
@@ -7,6 +7,39 @@
 #include "Engine/DataAsset.h"
 #include "VoxelGridConfig.generated.h"
 
+// Terrain feature used as distance field source
+UENUM(BlueprintType)
+enum class EVoxelDistanceFeature : uint8
+{
+	// Cells at or above a height
+	HeightAbove,
+
+	// Cells at or above a slope
+	SlopeAbove
+};
+
+// Height raster tile used by the DEM importer (GeoTIFF or 16-bit raw)
+USTRUCT(BlueprintType)
+struct FVoxelDemTileSource
+{
+	GENERATED_BODY()
+
+	// Raster file (.tif/.tiff uncompressed GeoTIFF, .r16/.raw 16-bit little-endian)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DEM", meta=(FilePathFilter="Height rasters (*.tif;*.tiff;*.r16;*.raw)|*.tif;*.tiff;*.r16;*.raw"))
+	FFilePath File;
+
+	// Raw only: raster size in pixels (GeoTIFF reads it from the file)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DEM|Raw")
+	FIntPoint RawSize = FIntPoint(0, 0);
+
+	// Raw only: upper-left corner in geo coordinates (easting, northing in meters)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DEM|Raw")
+	FVector2D RawGeoOriginMeters = FVector2D::ZeroVector;
+
+	// Raw only: pixel size (meters)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DEM|Raw")
+	float RawPixelSizeMeters = 1.0f;
+};
 
 UCLASS()
 class ASP_OSWALD_LEANDRO_API UVoxelGridConfig : public UDataAsset
@@ -46,4 +79,70 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Sampling")
 	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
 
+	// Adaptive sampling: coarse corner/center pattern, refine only uneven cells
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Sampling|Adaptive")
+	bool bAdaptiveSampling = false;
+
+	// Height spread within a quad that triggers refinement (meters)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Sampling|Adaptive", meta=(ClampMin="0.0"))
+	float AdaptiveToleranceMeters = 1.0f;
+
+	// Maximum refinement depth per cell (0 = corners + center only)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Sampling|Adaptive", meta=(ClampMin="0", ClampMax="6"))
+	int32 AdaptiveMaxDepth = 2;
+
+	// Also trace every lattice point of each cell and log max error of the adaptive result (debug, extra traces)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Sampling|Adaptive")
+	bool bAdaptiveReportError = false;
+
+	// DEM tiles imported directly into the height cache (no landscape needed)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DEM")
+	TArray<FVoxelDemTileSource> DemTiles;
+
+	// Geo coordinate (easting, northing in meters) placed at world origin; northing maps to -Y
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DEM")
+	FVector2D DemGeoOriginMeters = FVector2D::ZeroVector;
+
+	// Raster value -> meters: Value * DemValueScale + DemValueOffsetMeters
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DEM")
+	float DemValueScale = 1.0f;
+
+	// Raster value offset (meters), also used to shift elevations into world Z
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DEM")
+	float DemValueOffsetMeters = 0.0f;
+
+	// Produce a distance-to-feature channel after every bake (FeatureDistance)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DistanceField")
+	bool bBakeDistanceField = false;
+
+	// Feature predicate for the distance field
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DistanceField")
+	EVoxelDistanceFeature DistanceFeature = EVoxelDistanceFeature::HeightAbove;
+
+	// HeightAbove: threshold above sea level (meters)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DistanceField")
+	float DistanceHeightThresholdMeters = 100.0f;
+
+	// SlopeAbove: threshold slope (degrees)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="DistanceField", meta=(ClampMin="0.0", ClampMax="89.0"))
+	float DistanceSlopeDegrees = 30.0f;
+
+	// Produce horizon-angle channel after every bake (HorizonAngle, for sun shadow / sky visibility)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Horizon")
+	bool bBakeHorizonMap = false;
+
+	// Azimuth directions per cell
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Horizon", meta=(ClampMin="4", ClampMax="64"))
+	int32 HorizonAzimuths = 16;
+
+	// Horizon search distance (cells)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Horizon", meta=(ClampMin="1"))
+	int32 HorizonMaxDistanceCells = 64;
+
+	// Skip re-bakes with unchanged inputs and reuse stored results (Saved/VoxelBakeCache)
+	// Hash covers landscape heights + config only: other actors hit on TraceChannel (meshes, buildings)
+	// are not part of it, so disable this (or change the landscape) after adding/moving such actors
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Cache")
+	bool bUseBakeCache = true;
+
 };
\ No newline at end of file
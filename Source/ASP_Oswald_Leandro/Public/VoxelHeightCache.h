@@ -1,70 +1,260 @@
 // Runtime data container for baked voxel height results
 // Stores per-cell max height and grid metadata
+// Heights live only in the two snapshot buffers; all height queries read the current snapshot
 
 #pragma once
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "Async/Future.h"
+#include <atomic>
 #include "VoxelHeightCache.generated.h"
 
+struct FVoxelViewshedSettings;
+struct FVoxelViewshedResult;
 
-UCLASS(BlueprintType, Blueprintable)
-class ASP_OSWALD_LEANDRO_API UVoxelHeightCache : public UDataAsset
+// Immutable height grid published by the cache (safe to read from any thread)
+struct ASP_OSWALD_LEANDRO_API FVoxelHeightSnapshot
 {
-	GENERATED_BODY()
-
-public:
 	// Grid minimum world-space corner (XY)
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Grid")
 	FVector GridMinWorld = FVector::ZeroVector;
 
 	// Grid resolution in cells (X,Y)
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Grid")
 	FIntPoint GridSize = FIntPoint(0, 0);
 
 	// Grid cell size in centimeters
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Grid")
 	float CellSizeCm = 0.0f;
 
 	// Per-cell maximum world Z value (cm)
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Data")
 	TArray<float> MaxHeightCm;
 
-	// Optional sea level reference in world Z (cm)
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Data")
-	float SeaLevelWorldZCm = 0.0f;
-
-	// Allocate storage for grid and initialize values
-	UFUNCTION(BlueprintCallable, Category="Data")
-	void Allocate(int32 SizeX, int32 SizeY)
+	// Set grid metadata and initialize all cells as invalid height
+	void Reset(const FVector& InGridMinWorld, const FIntPoint& InGridSize, float InCellSizeCm)
 	{
-		GridSize = FIntPoint(SizeX, SizeY);
-		MaxHeightCm.SetNum(SizeX * SizeY);
-		
-		// Initialize as invalid height
-		for (float& V : MaxHeightCm) V = -FLT_MAX;
+		GridMinWorld = InGridMinWorld;
+		GridSize = InGridSize;
+		CellSizeCm = InCellSizeCm;
+		MaxHeightCm.Init(-FLT_MAX, InGridSize.X * InGridSize.Y);
 	}
 
-	// Check if cache data is valid and consistent
-	UFUNCTION(BlueprintCallable, Category="Data")
+	// Check if snapshot data is valid and consistent
 	bool IsValid() const
 	{
 		return CellSizeCm > 0.0f && GridSize.X > 0 && GridSize.Y > 0 && MaxHeightCm.Num() == GridSize.X * GridSize.Y;
 	}
 
+	// Check if cell coordinates lie inside the grid
+	bool IsValidCell(int32 X, int32 Y) const
+	{
+		return X >= 0 && Y >= 0 && X < GridSize.X && Y < GridSize.Y;
+	}
+
 	// Convert 2D cell coordinates to flat array index
-	UFUNCTION(BlueprintCallable, Category="Data")
 	int32 ToIndex(int32 X, int32 Y) const
 	{
 		return X + Y * GridSize.X;
 	}
+};
+
+// Derived per-cell data stored alongside the heights (analysis results)
+USTRUCT(BlueprintType)
+struct FVoxelCacheChannel
+{
+	GENERATED_BODY()
+
+	// Floats stored per cell
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Data")
+	int32 NumComponents = 1;
+
+	// Per-cell values, row-major, NumComponents floats per cell
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Data")
+	TArray<float> Values;
+
+	// Producer settings the values were computed with (empty if none; differing settings need a full recompute)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Data")
+	FString Settings;
+};
+
+
+UCLASS(BlueprintType, Blueprintable)
+class ASP_OSWALD_LEANDRO_API UVoxelHeightCache : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Grid minimum world-space corner (XY) of the current snapshot (game thread mirror)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Grid")
+	FVector GridMinWorld = FVector::ZeroVector;
+
+	// Grid resolution in cells (X,Y) of the current snapshot (game thread mirror)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Grid")
+	FIntPoint GridSize = FIntPoint(0, 0);
+
+	// Grid cell size in centimeters of the current snapshot (game thread mirror)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Grid")
+	float CellSizeCm = 0.0f;
+
+	// Optional sea level reference in world Z (cm)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Data")
+	float SeaLevelWorldZCm = 0.0f;
+
+	// Content hash of the bake that produced this data (empty if unknown)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Data")
+	FString BakeHash;
+
+	// Named analysis channels (same grid as the current snapshot; dropped on every publish)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Channels")
+	TMap<FName, FVoxelCacheChannel> Channels;
+
+	// Store channel values (must match grid size x NumComponents)
+	bool SetChannel(FName Name, TArray<float>&& Values, int32 NumComponents = 1, const FString& Settings = FString());
+
+	// Find channel by name (nullptr if missing)
+	const FVoxelCacheChannel* FindChannel(FName Name) const;
+
+	// Read single channel value (Fallback if channel or cell missing)
+	UFUNCTION(BlueprintCallable, Category="Channels")
+	float GetChannelValue(FName Name, int32 X, int32 Y, int32 Component = 0, float Fallback = 0.0f) const;
+
+	// Read channel value of the cell containing world XY (Fallback outside grid)
+	UFUNCTION(BlueprintCallable, Category="Channels")
+	float GetChannelValueAtWorld(FName Name, const FVector& WorldPos, int32 Component = 0, float Fallback = 0.0f) const;
+
+	// Terrain shadow at world XY for a direction toward the sun (needs HorizonAngle channel; false if missing)
+	UFUNCTION(BlueprintCallable, Category="Channels")
+	bool IsInTerrainShadow(const FVector& WorldPos, const FVector& SunDirection) const;
+
+	// Visible sky fraction at world XY, 1 = open (needs HorizonAngle channel; 1 if missing)
+	UFUNCTION(BlueprintCallable, Category="Channels")
+	float GetSkyVisibility(const FVector& WorldPos) const;
+
+	// Publish an empty grid (all cells invalid) with current grid metadata
+	UFUNCTION(BlueprintCallable, Category="Data")
+	void Allocate(int32 SizeX, int32 SizeY);
+
+	// Claim back buffer for writing (waits until no reader holds it); nullptr while another write is in progress
+	FVoxelHeightSnapshot* BeginWrite();
+
+	// Atomically swap back buffer in as current snapshot and end the write (game thread: mirrors grid metadata, drops channels)
+	void Publish();
+
+	// End the write without publishing (back buffer contents are discarded)
+	void AbortWrite();
+
+	// A writer currently owns the back buffer
+	bool IsWriteInProgress() const { return bWriteInProgress.load(); }
+
+	// Id of the current write (changes with every BeginWrite); a background writer publishes only while it still owns it
+	uint32 GetWriteId() const { return WriteId; }
+	bool OwnsWrite(uint32 InWriteId) const { return bWriteInProgress.load() && WriteId == InWriteId; }
+
+	// Hand the current write to a worker task (CancelWrite waits for it)
+	void SetWriteTask(TFuture<void>&& Task);
+
+	// Worker side: stop writing as soon as possible
+	bool IsWriteCancelled() const { return bWriteCancelled.load(); }
+
+	// Game thread: cancel the current write, wait for its worker and release the back buffer
+	void CancelWrite();
+
+	// Thread-safe: max height at world XY from current snapshot
+	bool GetMaxHeightAtWorld(const FVector& WorldPos, float& OutHeightCm) const;
+
+	// Thread-safe: max height of a cell (cm, -FLT_MAX if outside grid or no terrain)
+	UFUNCTION(BlueprintCallable, Category="Data")
+	float GetMaxHeightCm(int32 X, int32 Y) const;
+
+	// Thread-safe: cell containing world XY (false outside grid)
+	bool WorldToCell(const FVector& WorldPos, int32& OutX, int32& OutY) const;
+
+	// Thread-safe: visibility mask around an observer from current snapshot
+	bool ComputeViewshed(const FVoxelViewshedSettings& Settings, FVoxelViewshedResult& OutResult) const;
+
+	// Check if current snapshot is valid and consistent
+	UFUNCTION(BlueprintCallable, Category="Data")
+	bool IsValid() const;
+
+	// Convert 2D cell coordinates to flat array index (current snapshot layout)
+	UFUNCTION(BlueprintCallable, Category="Data")
+	int32 ToIndex(int32 X, int32 Y) const;
+
+	// Build this cache at a coarser cell size from a finer baked cache (max-reduction, no re-tracing)
+	UFUNCTION(BlueprintCallable, Category="Data")
+	bool DeriveCoarserFrom(const UVoxelHeightCache* Source, float NewCellSizeCm);
 
 	// Get height above sea level in meters
 	UFUNCTION(BlueprintCallable, Category="Data")
-	float GetHeightMetersASL(int32 X, int32 Y) const
+	float GetHeightMetersASL(int32 X, int32 Y) const;
+
+	// Heights are written from the current snapshot while saving and moved into it while loading
+	virtual void Serialize(FArchive& Ar) override;
+
+private:
+	friend class FVoxelHeightReadScope;
+
+	// Serialized per-cell maximum world Z (cm); only filled during save/load, empty otherwise
+	UPROPERTY()
+	TArray<float> MaxHeightCm;
+
+	// Register reader on current front buffer (lock-free, retries only across a publish)
+	int32 AcquireRead() const;
+
+	// Release reader registered by AcquireRead
+	void ReleaseRead(int32 Index) const;
+
+	// Swap back buffer to front without touching properties
+	void SwapBuffers();
+
+	// Move serialized heights + grid metadata into the front snapshot
+	void SyncSnapshotFromProperties();
+
+	// Front/back snapshot buffers
+	FVoxelHeightSnapshot Buffers[2];
+
+	// Index of current front buffer
+	std::atomic<int32> FrontIndex{0};
+
+	// Back buffer owned by a writer (single writer rule)
+	std::atomic<bool> bWriteInProgress{false};
+
+	// Current writer asked to stop
+	std::atomic<bool> bWriteCancelled{false};
+
+	// Incremented per BeginWrite (game thread)
+	uint32 WriteId = 0;
+
+	// Worker filling the back buffer (background writes only)
+	TFuture<void> WriteTask;
+
+	// Active readers per buffer
+	mutable std::atomic<int32> ReaderCounts[2] = {};
+};
+
+// Scoped lock-free read access to the current height snapshot
+// Snapshot stays consistent for the scope lifetime, even while a re-bake publishes
+class FVoxelHeightReadScope
+{
+public:
+	explicit FVoxelHeightReadScope(const UVoxelHeightCache& InCache)
+		: Cache(InCache)
+		, Index(InCache.AcquireRead())
 	{
-		const int32 Idx = ToIndex(X, Y);
-		if (!MaxHeightCm.IsValidIndex(Idx)) return 0.0f;
-		return (MaxHeightCm[Idx] - SeaLevelWorldZCm) / 100.0f;
 	}
+
+	~FVoxelHeightReadScope()
+	{
+		Cache.ReleaseRead(Index);
+	}
+
+	UE_NONCOPYABLE(FVoxelHeightReadScope);
+
+	// Current snapshot (immutable while scope is alive)
+	const FVoxelHeightSnapshot& Get() const
+	{
+		return Cache.Buffers[Index];
+	}
+
+private:
+	const UVoxelHeightCache& Cache;
+	const int32 Index;
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+// Horizon-angle maps on the baked height grid
+// Per-cell horizon elevation for N azimuths; sun-shadow and sky-visibility lookups by interpolation
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVoxelHeightSnapshot;
+
+// Horizon map parameters
+struct ASP_OSWALD_LEANDRO_API FVoxelHorizonSettings
+{
+	// Azimuth directions per cell (azimuth i = 360 * i / N degrees, 0 = +X, 90 = +Y)
+	int32 NumAzimuths = 16;
+
+	// Search distance along each direction (cells)
+	int32 MaxDistanceCells = 64;
+};
+
+class ASP_OSWALD_LEANDRO_API FVoxelHorizonMap
+{
+public:
+	// Channel name used when the map is stored in the height cache (NumAzimuths components, radians)
+	static const FName HorizonChannel;
+
+	// Horizon elevation angles for all cells (row-major, NumAzimuths per cell)
+	static bool Compute(const FVoxelHeightSnapshot& Snapshot, const FVoxelHorizonSettings& Settings, TArray<float>& OutAngles);
+
+	// Recompute cells whose horizon can see DirtyCells (rect grown by MaxDistanceCells); InOutAngles must come from the same settings
+	static bool UpdateRegion(const FVoxelHeightSnapshot& Snapshot, const FVoxelHorizonSettings& Settings, const FIntRect& DirtyCells, TArray<float>& InOutAngles);
+
+	// Horizon elevation (radians) toward an azimuth, interpolated between neighbouring directions
+	static float SampleHorizon(const float* CellAngles, int32 NumAzimuths, float AzimuthRad);
+
+	// Visible sky fraction: 1 - mean(sin(horizon)), horizons below horizontal count as open
+	static float SkyVisibility(const float* CellAngles, int32 NumAzimuths);
+};
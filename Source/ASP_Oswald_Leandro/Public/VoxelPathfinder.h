@@ -0,0 +1,117 @@
+// Hierarchical pathfinding (HPA*) over the baked height grid
+// Cluster/portal abstraction with slope-based edge costs, incremental cluster updates
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+
+struct FVoxelHeightSnapshot;
+
+// Pathfinding parameters
+struct ASP_OSWALD_LEANDRO_API FVoxelPathSettings
+{
+	// Cluster edge length in cells
+	int32 ClusterSize = 16;
+
+	// Steeper moves between neighbour cells are blocked (degrees)
+	float MaxSlopeDegrees = 35.0f;
+
+	// Move cost = distance * (1 + SlopeCostFactor * slope)
+	float SlopeCostFactor = 2.0f;
+
+	// Allow diagonal moves
+	bool bAllowDiagonal = true;
+};
+
+// Path query result
+struct ASP_OSWALD_LEANDRO_API FVoxelPathResult
+{
+	// Cells from start to goal (inclusive)
+	TArray<FIntPoint> Cells;
+
+	// Total path cost (cm, slope-weighted)
+	float Cost = 0.0f;
+
+	// Abstract nodes expanded by the high-level search
+	int32 ExpandedNodes = 0;
+};
+
+class ASP_OSWALD_LEANDRO_API FVoxelPathfinder
+{
+public:
+	// Build full abstraction from snapshot (copies heights)
+	void Build(const FVoxelHeightSnapshot& Snapshot, const FVoxelPathSettings& InSettings);
+
+	// Re-read heights inside DirtyCells (min inclusive, max exclusive) and rebuild affected clusters only
+	void UpdateRegion(const FVoxelHeightSnapshot& Snapshot, const FIntRect& DirtyCells);
+
+	// Thread-safe path query (many queries may run concurrently)
+	bool FindPath(const FIntPoint& Start, const FIntPoint& Goal, FVoxelPathResult& OutResult) const;
+
+	// Abstraction available
+	bool IsBuilt() const;
+
+	// Number of live abstract nodes
+	int32 GetNumNodes() const;
+
+private:
+	// Abstract graph edge
+	struct FEdge
+	{
+		int32 To = INDEX_NONE;
+		float Cost = 0.0f;
+		bool bInter = false;
+	};
+
+	// Portal node on a cluster border
+	struct FNode
+	{
+		int32 Cell = INDEX_NONE;
+		int32 Cluster = INDEX_NONE;
+		int32 Border = INDEX_NONE;
+		TArray<FEdge> Edges;
+		bool bAlive = false;
+	};
+
+	// Cost of moving between neighbour cells (negative = blocked)
+	float StepCost(int32 FromCell, int32 ToCell, bool bDiagonal) const;
+
+	// Cell rectangle of a cluster (max exclusive)
+	FIntRect GetClusterRect(int32 Cluster) const;
+
+	// Cluster index containing a cell
+	int32 GetClusterOfCell(int32 X, int32 Y) const;
+
+	// Dijkstra restricted to a rectangle; optional early stop at StopCell
+	void SearchInRect(const FIntRect& Rect, int32 StartCell, int32 StopCell, TArray<float>& OutCost, TArray<int32>& OutParent) const;
+
+	// Append cell path from local search parents (excluding StartCell)
+	void AppendLocalPath(const FIntRect& Rect, int32 StartCell, int32 GoalCell, const TArray<int32>& Parent, TArray<FIntPoint>& OutCells) const;
+
+	// Rebuild given clusters (plus borders/neighbours they touch)
+	void RebuildClusters(const TArray<int32>& DirtyClusters);
+
+	// Create portal nodes along one cluster border
+	void BuildBorderEntrances(int32 Border);
+
+	// Recompute intra-cluster edges between all portals of a cluster
+	void BuildIntraEdges(int32 Cluster);
+
+	// Allocate node (reuses free slots)
+	int32 AddNode(int32 Cell, int32 Cluster, int32 Border);
+
+	FVoxelPathSettings Settings;
+	FIntPoint GridSize = FIntPoint(0, 0);
+	float CellSizeCm = 0.0f;
+	float MaxSlope = 0.0f;
+	TArray<float> Heights;
+
+	FIntPoint NumClusters = FIntPoint(0, 0);
+	TArray<TArray<int32>> ClusterNodes;
+	TArray<FNode> Nodes;
+	TArray<int32> FreeNodes;
+
+	// Queries read-lock, build/update write-lock
+	mutable FRWLock Lock;
+};
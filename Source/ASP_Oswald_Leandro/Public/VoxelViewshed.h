@@ -0,0 +1,57 @@
+// Viewshed (line-of-sight visibility) from an observer on the baked height grid
+// Radial ring sweep (XDraw) per octant, octants run in parallel
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVoxelHeightSnapshot;
+
+// Viewshed input
+struct ASP_OSWALD_LEANDRO_API FVoxelViewshedSettings
+{
+	// Observer world position (only XY used; Z comes from the grid)
+	FVector ObserverWorld = FVector::ZeroVector;
+
+	// Eye height above ground at observer cell (cm)
+	float ObserverHeightCm = 200.0f;
+
+	// Height above ground of target points (cm)
+	float TargetHeightCm = 0.0f;
+
+	// Maximum view distance in cells
+	int32 MaxRadiusCells = 100;
+};
+
+// Visibility mask over a square window centered on the observer cell
+struct ASP_OSWALD_LEANDRO_API FVoxelViewshedResult
+{
+	// Observer cell
+	FIntPoint ObserverCell = FIntPoint(0, 0);
+
+	// Window radius (cells); window is (2R+1)^2 cells
+	int32 Radius = 0;
+
+	// 1 = visible, 0 = hidden or outside grid/radius
+	TArray<uint8> Visible;
+
+	// Number of visible cells
+	int32 NumVisible = 0;
+
+	// Visibility of grid cell (false outside window)
+	bool IsVisible(int32 X, int32 Y) const
+	{
+		const int32 DX = X - ObserverCell.X;
+		const int32 DY = Y - ObserverCell.Y;
+		if (FMath::Abs(DX) > Radius || FMath::Abs(DY) > Radius)
+			return false;
+		return Visible[(DX + Radius) + (DY + Radius) * (2 * Radius + 1)] != 0;
+	}
+};
+
+class ASP_OSWALD_LEANDRO_API FVoxelViewshed
+{
+public:
+	// Compute visibility mask around observer (false if observer outside grid or on invalid cell)
+	static bool Compute(const FVoxelHeightSnapshot& Snapshot, const FVoxelViewshedSettings& Settings, FVoxelViewshedResult& OutResult);
+};